@@ -0,0 +1,91 @@
+//==============================================================================
+// File       : gif_encode.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Benchmark of encoding synthetic 200 frame GIF animation
+//==============================================================================
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "consoleartlib/images/formats/gif_encoder.h"
+#include "consoleartlib/images/utils/color_quantizer.h"
+#include "consoleartlib/images/utils/parallel.hpp"
+
+using namespace consoleartlib;
+
+static constexpr int WIDTH = 320;
+static constexpr int HEIGHT = 240;
+static constexpr int FRAMES = 200;
+
+/**
+ * Gradient scrolling under a square moving across it, so frames change everywhere and in one spot the most.
+ */
+static std::vector<PixelBuffer> makeFrames()
+{
+	std::vector<PixelBuffer> frames(FRAMES, PixelBuffer(static_cast<size_t>(WIDTH) * HEIGHT * 4));
+	for (int index = 0; index < FRAMES; index++)
+	{
+		uint8_t* pixel = frames[index].data();
+		const int SQUARE_X = index * (WIDTH - 40) / FRAMES;
+		const int SQUARE_Y = (HEIGHT - 40) / 2;
+		for (int y = 0; y < HEIGHT; y++)
+		{
+			for (int x = 0; x < WIDTH; x++, pixel += 4)
+			{
+				const bool SQUARE = x >= SQUARE_X && x < SQUARE_X + 40 && y >= SQUARE_Y && y < SQUARE_Y + 40;
+				pixel[0] = SQUARE ? 255 : static_cast<uint8_t>(x + index);
+				pixel[1] = SQUARE ? 64 : static_cast<uint8_t>(y * 2);
+				pixel[2] = SQUARE ? 32 : static_cast<uint8_t>((x + y) / 2 + index);
+				pixel[3] = 255;
+			}
+		}
+	}
+	return frames;
+}
+
+static void encode(const std::vector<PixelBuffer>& frames, unsigned threads, bool globalPalette)
+{
+	const auto START = std::chrono::steady_clock::now();
+	// Global palette is counted the way ImageGIF::saveAnimation() does it, one quantizer per worker merged afterwards
+	const unsigned WORKERS = workerCount(threads, frames.size());
+	std::vector<ColorQuantizer> parts(globalPalette ? WORKERS : 0, ColorQuantizer(255));
+	parallelFor(parts.size(), [&](size_t part)
+	{
+		for (size_t index = part * frames.size() / WORKERS; index < (part + 1) * frames.size() / WORKERS; index++)
+			parts[part].addPixels(frames[index].data(), static_cast<size_t>(WIDTH) * HEIGHT);
+	}, WORKERS);
+	for (size_t part = 1; part < parts.size(); part++)
+		parts[0].merge(parts[part]);
+	if (globalPalette)
+		parts[0].buildPalette();
+	std::ostringstream stream;
+	GIFEncoder encoder(stream, WIDTH, HEIGHT, threads, globalPalette ? &parts[0] : nullptr);
+	for (const PixelBuffer& frame : frames)
+		encoder.addFrame(frame.data(), static_cast<size_t>(WIDTH) * 4, 40);
+	const bool DONE = encoder.finish();
+	const std::chrono::duration<double, std::milli> ELAPSED = std::chrono::steady_clock::now() - START;
+	std::cout << (globalPalette ? "Global palette" : "Local palettes") << ", " << threads << " thread(s): "
+		<< ELAPSED.count() << " ms, " << stream.str().size() << " bytes" << (DONE ? "" : " (failed)") << "\n";
+}
+
+int main(int argc, char** argv)
+{
+	const unsigned THREADS = (argc > 1) ? static_cast<unsigned>(std::atoi(argv[1])) : std::max(std::thread::hardware_concurrency(), 1u);
+	const std::vector<PixelBuffer> FRAMES_DATA = makeFrames();
+	std::cout << FRAMES << " frames of " << WIDTH << "x" << HEIGHT << "\n";
+	for (bool globalPalette : {false, true})
+	{
+		encode(FRAMES_DATA, 1, globalPalette);
+		if (THREADS > 1)
+			encode(FRAMES_DATA, THREADS, globalPalette);
+	}
+	return 0;
+}
@@ -2,7 +2,7 @@
 // File       : ImageTools.h
 // Author     : riyufuchi
 // Created on : Dec 01, 2023
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2023, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -36,8 +36,55 @@ inline unsigned char* convertPlanarToInterleaved(const unsigned char* planarData
 
 	return interleavedData;
 }
+std::unique_ptr<unsigned char[]> interleaveView(const consoleartlib::ConstImageView& planarView);
 std::unique_ptr<unsigned char[]> convertPlanarPCXToInterleaved(const consoleartlib::ImagePCX& image);
 std::unique_ptr<unsigned char[]> convertPlanarPCXToInterleaved(const consoleartlib::ImagePCX::PagePCX& image);
 bool convertImage(const consoleartlib::Image& source, consoleartlib::Image& target);
+/**
+ * Applies operation to every pixel in place. The loop is instantiated for the layout of the view,
+ * so it contains no per pixel format checks.
+ *
+ * @param operation Callable taking consoleartlib::Pixel&
+ */
+template <typename PixelOperation>
+void forEachPixel(const consoleartlib::ImageView& view, PixelOperation operation)
+{
+	view.dispatch([&](const auto format)
+	{
+		const ptrdiff_t STEP = format.step();
+		for (int y = 0; y < view.getHeight(); y++)
+		{
+			uint8_t* data = view.row(y);
+			for (int x = 0; x < view.getWidth(); x++, data += STEP)
+			{
+				consoleartlib::Pixel pixel = format.load(data);
+				operation(pixel);
+				format.store(data, pixel);
+			}
+		}
+	});
+}
+template <typename PixelOperation>
+void forEachPixel(consoleartlib::Image& image, PixelOperation operation)
+{
+	forEachPixel(image.getView(), operation);
+}
+/**
+ * Streams image from reader to writer band by band, applying operation to every pixel on the way.
+ * Memory use depends on band height, not on image size.
+ *
+ * @return false when reading or writing failed
+ */
+template <typename PixelOperation>
+bool forEachPixel(consoleartlib::BandReader& reader, consoleartlib::BandWriter& writer, PixelOperation operation)
+{
+	while (const consoleartlib::ImageView band = reader.readBand())
+	{
+		forEachPixel(band, operation);
+		if (!writer.writeBand(band))
+			return false;
+	}
+	return reader.isValid() && writer.finish();
+}
 }
 #endif
@@ -2,7 +2,7 @@
 // File       : SimpleEdit.h
 // Author     : riyufuchi
 // Created on : Mar 21, 2025
-// Last edit  : Dec 20, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -13,6 +13,7 @@
 #include <cmath>
 
 #include "../image_formats.hpp"
+#include "image_tools.h"
 
 namespace consoleartlib::simple_edit
 {
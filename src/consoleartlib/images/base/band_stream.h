@@ -0,0 +1,102 @@
+//==============================================================================
+// File       : BandStream.h
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Reading and writing images a band of rows at a time
+//==============================================================================
+
+#ifndef IMAGES_BAND_STREAM_H_
+#define IMAGES_BAND_STREAM_H_
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+
+#include "image.h"
+
+namespace consoleartlib
+{
+/**
+ * Decodes image as a sequence of horizontal bands, so only one band is in memory at a time.
+ * Bands always go from top to bottom, whatever row order the file uses.
+ * Formats create readers with their static openBandReader().
+ */
+class BandReader
+{
+protected:
+	ImageInfo info;
+	TechnicalInfo technical;
+	ScanlineFormat format; // Row layout of returned bands
+	SourceStream stream;
+	PixelBuffer band;
+	int bandHeight;
+	int nextRow; // First row of the next band
+	/**
+	 * Decodes rows [nextRow, nextRow + count) into rows, one row every format.rowStride bytes.
+	 * @return false on broken or truncated data, with technical message set
+	 */
+	virtual bool decodeRows(uint8_t* rows, int count) = 0;
+public:
+	BandReader(const std::string& filepath, int bandHeight, const LoadOptions& options);
+	BandReader(const BandReader&) = delete;
+	BandReader& operator=(const BandReader&) = delete;
+	virtual ~BandReader();
+	/**
+	 * Decodes next band. The view points into the reader's buffer, so it can be modified in place,
+	 * and it is valid until the next call.
+	 * @return Empty view after the last band or on error (see isValid())
+	 */
+	ImageView readBand();
+	bool isValid() const;
+	bool isFinished() const;
+	int getNextRow() const;
+	int getBandHeight() const;
+	const ImageInfo& getImageInfo() const;
+	const std::string& getFileStatus() const;
+	const ScanlineFormat& getScanlineFormat() const;
+};
+/**
+ * Encodes image from bands given top to bottom. Bands may use any layout, they are converted
+ * to the file layout one band at a time. Formats create writers with their static createBandWriter().
+ */
+class BandWriter
+{
+protected:
+	ImageInfo info;
+	TechnicalInfo technical;
+	ScanlineFormat format; // Row layout the encoder expects
+	std::filebuf file; // Stays closed when writing into a stream given by the caller
+	std::ostream out;
+	PixelBuffer band;
+	int rowsWritten;
+	/**
+	 * Encodes rows [rowsWritten, rowsWritten + count), one row every format.rowStride bytes.
+	 */
+	virtual bool encodeRows(const uint8_t* rows, int count) = 0;
+	/// Called once after the last row, formats with trailers or deferred encoding finish the file here
+	virtual bool finishFile();
+public:
+	/**
+	 * @param target Stream receiving the image instead of a file, filepath only names the image then
+	 */
+	BandWriter(const std::string& filepath, int width, int height, std::ostream* target = nullptr);
+	BandWriter(const BandWriter&) = delete;
+	BandWriter& operator=(const BandWriter&) = delete;
+	virtual ~BandWriter();
+	/**
+	 * @param rows Band as wide as the image, it must not run past the last row
+	 */
+	bool writeBand(const ConstImageView& rows);
+	/**
+	 * Completes the file, fails when not all rows were written.
+	 */
+	bool finish();
+	bool isValid() const;
+	int getRowsWritten() const;
+	const ImageInfo& getImageInfo() const;
+	const std::string& getFileStatus() const;
+};
+} /* namespace consoleartlib */
+#endif /* IMAGES_BAND_STREAM_H_ */
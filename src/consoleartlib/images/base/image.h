@@ -2,7 +2,7 @@
 // File       : Image.h
 // Author     : Riyufuchi
 // Created on : Nov 20, 2023
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) Riyufuchi
 // Description: Abstract class for specific image formats
 //==============================================================================
@@ -19,8 +19,14 @@
 #include <algorithm>
 #include <cmath>
 #include <string>
+#include <string_view>
+#include <span>
 
 #include "../utils/pixels.hpp"
+#include "../utils/image_view.hpp"
+#include "../utils/box_filter.hpp"
+#include "../utils/source_stream.hpp"
+#include "../utils/memory_resources.h"
 
 namespace consoleartlib
 {
@@ -64,22 +70,108 @@ struct TechnicalInfo
 	std::string technicalMessage { "Pending/unknown" };
 	FileState fileState { FileState::INVALID_IMAGE_FILE };
 };
+/**
+ * Rectangle in upright coordinates, origin is top left whatever row order the file uses.
+ */
+struct ImageRegion
+{
+	int x { 0 };
+	int y { 0 };
+	int width { 0 };
+	int height { 0 };
+	bool isEmpty() const
+	{
+		return width <= 0 || height <= 0;
+	}
+};
+struct LoadOptions
+{
+	bool deferDecode { false }; // Only header is parsed in constructor, pixels are decoded on first access
+	std::span<const uint8_t> source; // Encoded file in memory, read instead of filepath when not empty. Must outlive the decoding
+	std::pmr::memory_resource* memoryResource { nullptr }; // Pixel buffers are allocated from it, nullptr means std::pmr::get_default_resource()
+	/**
+	 * Power of two. When set, pixel buffer starts at this alignment and every row of interleaved formats
+	 * is padded to its multiple, so SIMD kernels can process whole rows with aligned loads.
+	 * Planar (PCX, DCX) and HDR images keep their own row layout and get only the aligned buffer.
+	 */
+	size_t rowAlignment { 0 };
+	/**
+	 * When not empty, only this part of the image is decoded and the image gets its size.
+	 * It is clipped to the image, a region lying completely outside fails the load.
+	 */
+	ImageRegion region;
+	/**
+	 * Image is reduced by this factor while decoding (after the region is cut out), pixels are box averaged.
+	 * Only 1, 2, 4 and 8 are used, other values are rounded down to one of them.
+	 */
+	int downscale { 1 };
+	/**
+	 * Rows of bottom-up files (BMP) are flipped while loading, so the image is stored top-down
+	 * and getImageData() or upright views don't have to flip it.
+	 */
+	bool uprightRows { false };
+	/**
+	 * Multi-page formats decoding pages on demand (DCX) keep decoded pages up to this many bytes,
+	 * least recently used pages are dropped and decoded again from the file when needed. 0 means no limit.
+	 * Selected page, pages added by addImage() and pages edited through the image (setPixel(), writeScanline(),
+	 * non-const views and scanlines) are never dropped, until they are saved.
+	 */
+	size_t pageCacheBytes { 0 };
+	/**
+	 * Threads for work split by pages or frames, 0 means one per hardware thread.
+	 * Memory resource must be thread safe then, ArenaResource is used from one thread only.
+	 */
+	unsigned threads { 0 };
+};
 class Image
 {
 protected:
 	std::string filepath;
 	ImageInfo image;
 	TechnicalInfo technical;
-	std::vector<uint8_t> pixelData;
+	LoadOptions options;
+	PixelBuffer pixelData;
+	bool decodePending { false };
+	static std::pmr::memory_resource* selectResource(const LoadOptions& options);
+	static ImageRegion clipRegion(const ImageRegion& requested, int fullWidth, int fullHeight);
+	// Moving is protected, so images can't be sliced through base class references
+	Image(Image&& other) noexcept;
+	Image& operator=(Image&& other) noexcept;
+	void invalidate(std::string_view reason);
+	void deferDecode(const TechnicalInfo& probeResult);
+	void decodeNow();
+	/**
+	 * Decodes pixels of deferred image before they are touched. Pixel access is logically const,
+	 * so decoding from const methods is allowed to modify the image.
+	 */
+	void ensureDecoded() const
+	{
+		if (decodePending)
+			const_cast<Image*>(this)->decodeNow();
+	}
+	/// Bytes between rows of interleaved pixel data, including padding
+	size_t getRowStride() const
+	{
+		const size_t ROW_SIZE = static_cast<size_t>(image.width) * image.channels;
+		return options.rowAlignment ? (ROW_SIZE + options.rowAlignment - 1) & ~(options.rowAlignment - 1) : ROW_SIZE;
+	}
+	void importRows(const uint8_t* packedRows);
+	void importRegion(const uint8_t* packedRows, int fullWidth, const ImageRegion& region);
+	const uint8_t* exportRows(PixelBuffer& scratch) const;
+	virtual bool acceptLayout(ImageInfo& layout);
+	/**
+	 * Called before pixels are handed out for writing (non-const views and scanlines).
+	 */
+	virtual void markModified();
+	static void relayoutPixelData(PixelBuffer& data, int width, int height, const ScanlineFormat& from, bool fromInverted,
+			const ScanlineFormat& to, bool toInverted);
 public:
-	Image(const std::string& filepath, ImageType format = ImageType::UNKNOWN);
-	Image(Image&) = delete;
-	Image(Image&&) = delete;
+	Image(const std::string& filepath, ImageType format = ImageType::UNKNOWN, const LoadOptions& options = LoadOptions());
+	Image(const Image&) = delete;
 
 	virtual ~Image();
 
-	Image& operator=(Image&) = delete;
-	Image& operator=(Image&&) = delete;
+	Image& operator=(const Image&) = delete;
 
 	explicit operator bool() const
 	{
@@ -127,6 +219,7 @@ public:
 
 	// Utils
 	void rename(std::string imageName);
+	bool adoptPixelData(Image&& source);
 	bool containsPalette() const;
 	// Virtual utils
 	virtual bool saveImage() const = 0;
@@ -134,6 +227,7 @@ public:
 	//virtual void resize(int width, int heigh) = 0;
 	// Is methods
 	bool isLoaded() const;
+	bool isDecodePending() const;
 	bool isInverted() const;
 	// Getters
 	virtual const std::string& getFilename() const final;
@@ -145,7 +239,19 @@ public:
 	int getHeight() const;
 	int getBits() const;
 	PixelByteOrder getPixelFormat() const;
+	std::pmr::memory_resource* getMemoryResource() const;
 	std::unique_ptr<unsigned char[]> getImageData() const;
+	// Scanline access
+	virtual ScanlineFormat getScanlineFormat() const;
+	std::span<uint8_t> getScanline(int y);
+	std::span<const uint8_t> getScanline(int y) const;
+	void readScanline(int y, std::span<Pixel> row) const;
+	void writeScanline(int y, std::span<const Pixel> row);
+	// Views (no copy, valid until the pixel buffer is reallocated)
+	ImageView getView();
+	ConstImageView getView() const;
+	ImageView getUprightView();
+	ConstImageView getUprightView() const;
 	//Setters
 	virtual void setPixel(int x, int y, Pixel newPixel) = 0;
 };
@@ -0,0 +1,120 @@
+//==============================================================================
+// File       : GIFDecoder.h
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Decoding GIF animation one frame at a time
+//==============================================================================
+
+#ifndef IMAGES_GIF_DECODER_H_
+#define IMAGES_GIF_DECODER_H_
+
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "../base/image.h"
+#include "../utils/palette_lut.hpp"
+
+namespace consoleartlib
+{
+/**
+ * Frame as the file describes it, its rectangle is in canvas coordinates.
+ */
+struct GIFFrame
+{
+	int x { 0 };
+	int y { 0 };
+	int width { 0 };
+	int height { 0 };
+	int delay { 0 }; // Milliseconds
+	int disposal { 0 }; // 2 clears the rectangle after the frame, 3 restores what was there before it
+	int transparentIndex { -1 };
+	bool interlaced { false };
+	std::streampos position { 0 }; // First block of the frame (graphic control or image descriptor)
+};
+/**
+ * Composes frames on a single RGBA canvas, so memory doesn't grow with the number of frames:
+ * canvas, copy of the rectangle needed by "restore previous" disposal and buffers of one batch of frames.
+ * LZW streams of a batch are decompressed in parallel, only composing goes frame by frame
+ * as disposal of every frame depends on the previous one.
+ * Cleared and never drawn pixels are transparent black.
+ */
+class GIFDecoder
+{
+private:
+	/// Frame read from the file, decompressed but not composed yet
+	struct PendingFrame
+	{
+		GIFFrame frame;
+		PaletteLUT palette;
+		int minCodeSize { 0 };
+		PixelBuffer compressed;
+		PixelBuffer indexes;
+		size_t decoded { 0 };
+	};
+	SourceStream stream;
+	TechnicalInfo technical;
+	int width;
+	int height;
+	unsigned threads;
+	PaletteLUT globalPalette;
+	std::streampos firstBlock;
+	PixelBuffer canvas;
+	PixelBuffer saved; // Rectangle of the last frame before it was drawn, for disposal 3
+	std::vector<PendingFrame> batch;
+	GIFFrame frame;
+	int frameIndex; // Last composed frame, -1 before the first
+	bool finished;
+	bool readFrame(GIFFrame& next, PaletteLUT& palette, int& minCodeSize, PixelBuffer* compressed);
+	void disposeFrame();
+	void drawFrame(const PaletteLUT& palette, const uint8_t* indexes, size_t decoded);
+	static void skipSubBlocks(std::istream& stream);
+public:
+	/**
+	 * @param threads Workers decompressing frames of a batch, 0 means one per hardware thread
+	 */
+	GIFDecoder(const std::string& filepath, std::span<const uint8_t> source = {}, unsigned threads = 1);
+	GIFDecoder(const GIFDecoder&) = delete;
+	GIFDecoder& operator=(const GIFDecoder&) = delete;
+	/**
+	 * Decodes next frame and composes it over the canvas.
+	 * @return false after the last frame or on broken data (see isValid())
+	 */
+	bool nextFrame();
+	/**
+	 * Decodes up to count next frames in batches, LZW streams of a batch in parallel, and composes them in order.
+	 * @param composed Called after every composed frame, canvas and frame info of the decoder describe that frame
+	 * @return Number of composed frames
+	 */
+	size_t nextFrames(size_t count, const std::function<void(const GIFDecoder&)>& composed = nullptr);
+	/**
+	 * Composes frames until index is on the canvas, going back to the first frame when index was already passed.
+	 */
+	bool seekFrame(int index);
+	/// Canvas goes back to the state before the first frame
+	void rewind();
+	/**
+	 * Walks blocks of the whole file without decompressing them and returns to the current position.
+	 */
+	std::vector<GIFFrame> scanFrames();
+	bool isValid() const;
+	bool isFinished() const;
+	int getWidth() const;
+	int getHeight() const;
+	int getFrameIndex() const;
+	const GIFFrame& getFrameInfo() const;
+	/// Composed RGBA canvas, rows are width * 4 bytes long, empty until the first frame is decoded
+	const PixelBuffer& getCanvas() const;
+	const std::string& getFileStatus() const;
+	/**
+	 * Decompresses LZW code stream of one frame into palette indexes.
+	 * @return Number of indexes written, less than count when the data end early or are broken
+	 */
+	static size_t decodeLZW(std::span<const uint8_t> data, int minCodeSize, uint8_t* indexes, size_t count);
+};
+} /* namespace consoleartlib */
+#endif /* IMAGES_GIF_DECODER_H_ */
@@ -0,0 +1,81 @@
+//==============================================================================
+// File       : GIFEncoder.h
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Encoding RGBA frames into GIF animation
+//==============================================================================
+
+#ifndef IMAGES_GIF_ENCODER_H_
+#define IMAGES_GIF_ENCODER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <span>
+#include <vector>
+
+#include "../utils/pixels.hpp"
+#include "../utils/color_quantizer.h"
+
+namespace consoleartlib
+{
+/**
+ * Writes frames as they are added, frames of a batch are cropped, quantized and LZW compressed in parallel,
+ * only writing goes in order. Memory is bounded by the batch, not by the length of the animation.
+ *
+ * Pixels with alpha below 128 are transparent. Every frame after the first is cropped to the rectangle
+ * that changed, pixels inside it that didn't change are written transparent, so they compress into long runs.
+ * A frame that turns visible pixels transparent can't be drawn over the previous one,
+ * so the previous frame covers the whole canvas and is cleared after it (disposal 2) and this frame is written whole.
+ */
+class GIFEncoder
+{
+private:
+	struct PendingFrame
+	{
+		PixelBuffer rgba; // Whole canvas, rows are packed
+		int delay { 0 };
+		bool checked { false }; // clearsPrevious is known
+		bool clearsPrevious { false }; // Has transparent pixels where the previous frame was visible
+		PixelBuffer encoded; // Graphic control extension, image descriptor, local palette and LZW data
+	};
+	std::ostream& stream;
+	int width;
+	int height;
+	unsigned threads;
+	const ColorQuantizer* globalColors;
+	std::vector<PendingFrame> batch;
+	PixelBuffer previous; // Last written frame, next frames are cropped against it
+	size_t written;
+	bool headerWritten;
+	bool writeHeader(bool animated);
+	void encodeFrame(size_t index);
+	bool writeBatch(size_t count);
+public:
+	/**
+	 * @param threads Workers encoding frames of a batch, 0 means one per hardware thread
+	 * @param globalColors Built palette of at most 255 colors (index after it is transparent) shared by all frames,
+	 * it has to outlive the encoder. Without it every frame gets own palette.
+	 */
+	GIFEncoder(std::ostream& stream, int width, int height, unsigned threads = 1, const ColorQuantizer* globalColors = nullptr);
+	GIFEncoder(const GIFEncoder&) = delete;
+	GIFEncoder& operator=(const GIFEncoder&) = delete;
+	/**
+	 * Frame is copied, so the buffer can be reused right after the call.
+	 * @param rgba Interleaved RGBA rows of width * height canvas, rowStride bytes apart
+	 * @param delay Milliseconds, stored in hundredths of a second
+	 * @return false when writing of a finished batch failed
+	 */
+	bool addFrame(const uint8_t* rgba, size_t rowStride, int delay);
+	/**
+	 * Writes remaining frames and the trailer.
+	 */
+	bool finish();
+	/**
+	 * Compresses palette indexes into LZW code stream split into sub-blocks and appends it after minimum code size byte.
+	 */
+	static void encodeLZW(const uint8_t* indexes, size_t count, int minCodeSize, PixelBuffer& target);
+};
+} /* namespace consoleartlib */
+#endif /* IMAGES_GIF_ENCODER_H_ */
@@ -2,7 +2,7 @@
 // Name        : ImageBMP
 // Author      : Riyufuchi
 // Created on  : Jul 17, 2020
-// Last Edit   : Dec 19, 2025
+// Last Edit   : Oct 17, 2026
 // Description : This class loads uncompressed 24 or 32 bit bitmap image
 //============================================================================
 
@@ -14,11 +14,14 @@
 #include <vector>
 
 #include "../base/image.h"
+#include "../base/band_stream.h"
 
 namespace consoleartlib
 {
 class ImageBMP : public Image
 {
+	friend class BandReaderBMP;
+	friend class BandWriterBMP;
 private:
 	#pragma pack(push, 1)
 		struct BMPFileHeader
@@ -55,12 +58,16 @@ private:
 	#pragma pack(pop)
 	uint32_t row_stride;
 	// Methods
-	void checkHeader(std::ifstream& inf);
-	void readImageData(std::ifstream& inf);
+	void checkHeader(std::istream& inf);
+	bool readImageData(std::istream& inf, const ImageRegion& region);
 	bool checkColorHeader(BMPColorHeader &bmp_color_header, std::string* msg);
 	uint32_t makeStrideAligned(uint32_t align_stride);
+protected:
+	bool acceptLayout(ImageInfo& layout) override;
 public:
-	ImageBMP(const std::string& filename);
+	ImageBMP(const std::string& filename, const LoadOptions& options = LoadOptions());
+	ImageBMP(ImageBMP&&) = default;
+	ImageBMP& operator=(ImageBMP&&) = default;
 	bool saveImage() const override;
 	void loadImage() override;
 	// Setters
@@ -72,6 +79,12 @@ public:
 	uint8_t getBlue(int x, int y) const;
 	uint8_t getAplha(int x, int y) const;
 	~ImageBMP();
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
+	static std::unique_ptr<BandReader> openBandReader(const std::string& filepath, int bandHeight = 64, const LoadOptions& options = LoadOptions());
+	/**
+	 * @param channels 2 and 4 channel images are written as 32-bit, others as 24-bit
+	 */
+	static std::unique_ptr<BandWriter> createBandWriter(const std::string& filepath, int width, int height, int channels, std::ostream* target = nullptr);
 };
 }
 #endif
@@ -2,7 +2,7 @@
 // File       : ImageDCX.h
 // Author     : riyufuchi
 // Created on : Nov 13, 2025
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -21,28 +21,96 @@ struct ImageRange
 	uint32_t end   = 0;  // byte offset where image/header ends (exclusive)
 	uint32_t size() const { return end - start; }
 };
+/**
+ * Only offset table is read when the file is opened, pages are decoded when they are first selected
+ * (or their pixels are asked for) and kept in a cache bounded by LoadOptions::pageCacheBytes.
+ */
 class ImageDCX: public Image, public IMultiPage
 {
 private:
+	struct PageState
+	{
+		bool decoded { false };
+		bool pinned { false }; // Added or edited, it can't be decoded from the file again
+		size_t bytes { 0 };
+		uint64_t lastUse { 0 };
+	};
 	size_t selectedPage;
+	bool pageCheckedOut; // Pixels of selected page are moved into the image buffer
 	int numOfPages;
 	ImagePCX::HeaderPCX headerPCX;
+	std::string sourcePath; // Pages are decoded from here even after rename
 	std::vector<ImageRange> ranges;
 	std::vector<ImagePCX::PagePCX> pages;
+	std::vector<PageState> pageStates;
+	size_t cachedBytes; // Pixels of all decoded pages
+	uint64_t useCounter;
+	bool readPage(size_t index, ImagePCX::PagePCX& page) const;
+	bool readEncodedPage(size_t index, PixelBuffer& data) const;
+	bool decodePage(size_t index);
+	void cachePage(size_t index);
+	void evictPages();
+	unsigned pageThreads() const;
+protected:
+	bool acceptLayout(ImageInfo& layout) override;
+	void markModified() override;
 public:
-	ImageDCX(const std::string& filename);
+	static constexpr uint32_t MAGIC = 0x3ADE68B1;
+	/// Saved files have room for this many offsets (the last one is the terminator), so pages can be appended in place
+	static constexpr size_t TABLE_ENTRIES = 1024;
+	ImageDCX(const std::string& filename, const LoadOptions& options = LoadOptions());
 	ImageDCX(const std::string& filename, int numberOfPages);
+	ImageDCX(ImageDCX&&) = default;
 	virtual ~ImageDCX();
+	ImageDCX& operator=(ImageDCX&&) = default;
+	virtual ScanlineFormat getScanlineFormat() const override;
 	virtual consoleartlib::Pixel getPixel(int x, int y) const override;
 	virtual void setPixel(int x, int y, consoleartlib::Pixel newPixel) override;
 	virtual bool saveImage() const override;
 	virtual void loadImage() override;
 	//
 	virtual void selectPage(size_t index) override final;
-	const ImagePCX::PagePCX& getSelectedPage() const;
+	/**
+	 * Selected page seen through the image, its pixels are held by the image itself while the page is selected,
+	 * so the page can't be handed out as ImagePCX::PagePCX. Valid until another page is selected or decoded.
+	 */
+	struct SelectedPage
+	{
+		const ImagePCX::HeaderPCX& header;
+		const ImageInfo& image;
+		const std::vector<PixelRGB>& palette;
+		const std::string& msg;
+		std::span<const uint8_t> pixelData; // Planar rows, header.bytesPerLine per plane
+	};
+	SelectedPage getSelectedPage() const;
+	/**
+	 * Pixels of any page, page is decoded when it isn't cached.
+	 * The reference is valid until another page is decoded.
+	 */
+	const PixelBuffer& getPagePixels(size_t index) const;
+	/**
+	 * Decodes pages [first, first + count) that aren't cached, several at once (LoadOptions::threads).
+	 * Pages over the cache budget are dropped afterwards, least recently used first.
+	 */
+	void decodePages(size_t first, size_t count);
+	bool isPageDecoded(size_t index) const;
+	size_t getCachedBytes() const;
 	virtual size_t getSelectedPageIndex() const override final;
 	virtual size_t getPageCount() const override;
 	void addImage(ImagePCX::PagePCX image);
+	/**
+	 * Encodes page, writes it at the end of the file and fills its entry of the offset table.
+	 * Existing pages are neither read nor rewritten. Missing file is created.
+	 * @param written When not nullptr, receives where the page was written
+	 * @return false when the file isn't DCX, or its offset table is full (files written without spare entries)
+	 */
+	static bool appendPage(const std::string& filepath, const ImagePCX::PagePCX& page, ImageRange* written = nullptr);
+	/**
+	 * Appends page to the file of this image right away and adds it to the pages.
+	 * Pages added by addImage() are still written only by saveImage().
+	 */
+	bool appendImage(ImagePCX::PagePCX image);
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
 };
 
 } /* namespace consoleartlib */
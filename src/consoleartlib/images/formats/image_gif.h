@@ -2,7 +2,7 @@
 // File       : ImageGIF.h
 // Author     : riyufuchi
 // Created on : Nov 06, 2025
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -10,32 +10,81 @@
 #ifndef IMAGES_IMAGEGIF_H_
 #define IMAGES_IMAGEGIF_H_
 
+#include <functional>
+#include <string_view>
+
 #include "../base/image.h"
+#include "gif_decoder.h"
+#include "gif_encoder.h"
+#include "../utils/frame_store.h"
 #include "../interfaces/ianimated.hpp"
 #include "../interfaces/imulti_page.hpp"
 
 namespace consoleartlib
 {
 
+/**
+ * Frames are composed by GIFDecoder when they are first needed and kept in FrameStore
+ * as keyframes and rectangles that changed, so an animation costs about a full frame per keyframe
+ * instead of per frame. Going back rebuilds the frame from the store without decoding again.
+ * Edits of a frame are lost when another frame is selected.
+ * Saving writes every frame with own palette, see saveAnimation().
+ */
 class ImageGIF: public Image, public IAnimated, public IMultiPage
 {
 private:
-	std::vector<std::vector<uint8_t>> frames;
+	std::unique_ptr<GIFDecoder> decoder;
+	std::unique_ptr<FrameStore> frames; // Frames decoded so far, after region and downscale
 	std::vector<int> delays;
 	size_t selectedFrameIndex;
+	PixelBuffer frameScratch; // Frame returned by getFrame() for other than selected frame
+	bool composeFrame(size_t index, PixelBuffer& target);
+	void exportCanvas(const GIFDecoder& source, PixelBuffer& target) const;
+	TechnicalInfo exportFrame(size_t index, const std::string& filepath, ImageType type, std::ostream* target) const;
+	std::vector<TechnicalInfo> exportFrames(ImageType type, unsigned threads, const std::function<TechnicalInfo(size_t)>& task) const;
+protected:
+	bool acceptLayout(ImageInfo& layout) override;
 public:
-	ImageGIF(const std::string& filepath);
+	/// Receives encoded frame, see exportFrames()
+	using FrameSink = std::function<void(size_t index, std::string_view encoded)>;
+	ImageGIF(const std::string& filepath, const LoadOptions& options = LoadOptions());
+	ImageGIF(ImageGIF&&) = default;
 	~ImageGIF();
+	ImageGIF& operator=(ImageGIF&&) = default;
 	virtual consoleartlib::Pixel getPixel(int x, int y) const override;
 	virtual void setPixel(int x, int y, consoleartlib::Pixel newPixel) override;
 	virtual bool saveImage() const override;
+	/**
+	 * Writes all frames (selected one with its edits) with their delays, frames are encoded on LoadOptions::threads.
+	 * @param globalPalette One palette quantized from all frames instead of a palette per frame,
+	 * smaller file but less colors when frames differ. Colors of frames are counted on LoadOptions::threads too
+	 */
+	bool saveAnimation(bool globalPalette) const;
 	virtual void loadImage() override;
 	virtual void selectPage(size_t index) override;
 	virtual size_t getSelectedPageIndex() const override;
 	virtual size_t getPageCount() const override;
-	const std::vector<uint8_t>& getFrame(int index) const;
+	/**
+	 * Selected frame is returned as it is, other frames are rebuilt into a buffer,
+	 * which is valid until the next call. Every frame is decoded only once.
+	 * @return Empty buffer when the frame can't be decoded
+	 */
+	const PixelBuffer& getFrame(int index) const;
 	virtual int getFrameDelay(size_t index) const override;
-	bool spitIntoPNGs() const;
+	/**
+	 * Encodes frames (selected one with its edits) on several threads, every frame into own file
+	 * named <index>-<name>.<extension> in directory.
+	 * @param type BMP, PCX, PNG, PPM or TGA
+	 * @param threads 0 means one per hardware thread
+	 * @return Status of every frame, VALID_IMAGE_FILE when the frame was written
+	 */
+	std::vector<TechnicalInfo> exportFrames(const std::string& directory, ImageType type, unsigned threads = 0) const;
+	/**
+	 * Same as exporting into a directory, but encoded frames are handed to sink instead of files.
+	 * Sink is called from the workers one call at a time, frames come in any order.
+	 */
+	std::vector<TechnicalInfo> exportFrames(ImageType type, const FrameSink& sink, unsigned threads = 0) const;
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
 	//TODO: bool addFrame(const Image& frame, int index = 0);
 	//TODO: bool removeFrame(int index);
 };
@@ -2,7 +2,7 @@
 // File       : ImageHDR.h
 // Author     : riyufuchi
 // Created on : Nov 07, 2025
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -18,10 +18,15 @@ namespace consoleartlib
 class ImageHDR: public Image
 {
 private:
-	std::vector<float> pixelDataHDR;
+	std::pmr::vector<float> pixelDataHDR;
+	bool convertOnLoad;
+protected:
+	bool acceptLayout(ImageInfo& layout) override;
 public:
-	ImageHDR(const std::string& filename, bool convert = true);
+	ImageHDR(const std::string& filename, bool convert = true, const LoadOptions& options = LoadOptions());
+	ImageHDR(ImageHDR&&) = default;
 	virtual ~ImageHDR();
+	ImageHDR& operator=(ImageHDR&&) = default;
 	PixelHDR getPixelHDR(int x, int y) const;
 	void setPixelHDR(int x, int y, PixelHDR newPixel);
 	void convertTo8bit();
@@ -31,6 +36,7 @@ public:
 	virtual void setPixel(int x, int y, consoleartlib::Pixel newPixel) override;
 	virtual bool saveImage() const override;
 	virtual void loadImage() override;
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
 };
 
 } /* namespace consoleartlib */
@@ -2,7 +2,7 @@
 // File       : ImageJPG.h
 // Author     : riyufuchi
 // Created on : Feb 28, 2025
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -17,13 +17,16 @@ namespace consoleartlib
 class ImageJPG : public Image
 {
 public:
-	ImageJPG(const std::string& filepath);
+	ImageJPG(const std::string& filepath, const LoadOptions& options = LoadOptions());
 	ImageJPG(const std::string& filepath, int width, int height, int channels);
+	ImageJPG(ImageJPG&&) = default;
 	~ImageJPG();
+	ImageJPG& operator=(ImageJPG&&) = default;
 	virtual consoleartlib::Pixel getPixel(int x, int y) const override;
 	virtual void setPixel(int x, int y, consoleartlib::Pixel newPixel) override;
 	virtual bool saveImage() const override;
 	virtual void loadImage() override;
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
 };
 } /* namespace consoleartlib */
 #endif /* IMAGES_IMAGEJPG_H_ */
@@ -2,7 +2,7 @@
 // File       : ImagePCX.h
 // Author     : Riyufuchi
 // Created on : Nov 22, 2023
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) Riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -12,13 +12,18 @@
 
 #include <vector>
 #include <iostream>
+#include <functional>
 
 #include "../base/image.h"
+#include "../base/band_stream.h"
+#include "../utils/palette_lut.hpp"
 
 namespace consoleartlib
 {
 class ImagePCX : public Image
 {
+	friend class BandReaderPCX;
+	friend class BandWriterPCX;
 public:
 	#pragma pack(push, 1)
 	struct HeaderPCX
@@ -33,7 +38,7 @@ public:
 		uint16_t yMax {0};    // Image dimensions (right-bottom corner)
 		uint16_t horizontalDPI {0}; // Horizontal resolution
 		uint16_t verticalDPI {0};   // Vertical resolution
-		PixelRGB palette[16]; // uint8_t palette[48] {0};    // Color palette (16 colors)
+		PixelRGB palette[16] {}; // uint8_t palette[48] {0};    // Color palette (16 colors)
 		uint8_t reserved1 {0};       // Reserved (always 0)
 		uint8_t numOfColorPlanes {0}; // Number of color planes
 		uint16_t bytesPerLine {0};  // Bytes per scanline
@@ -47,34 +52,138 @@ public:
 	{
 		HeaderPCX header;
 		ImageInfo image;
-		std::vector<unsigned char> pixelData;
+		PixelBuffer pixelData;
 		std::string msg { "OK" };
-		PixelRGB* palette = nullptr;
+		std::vector<PixelRGB> palette;
 	};
 private:
+	/**
+	 * Expands runs of encoded data into caller's buffers. Run crossing the end of a buffer is carried over
+	 * to the next fill, so data can be decoded a scanline at a time and fed in chunks.
+	 * Writes never go past the size given to fill().
+	 */
+	class RunDecoder
+	{
+	private:
+		std::span<const uint8_t> data;
+		size_t position {0};
+		size_t runLeft {0};
+		uint8_t runValue {0};
+		bool valuePending {false}; // Run count was the last byte of previous data
+		bool encoded;
+	public:
+		explicit RunDecoder(bool encoded) : encoded(encoded)
+		{
+		}
+		/// Replaces consumed data with the next part of them
+		void feed(std::span<const uint8_t> data)
+		{
+			this->data = data;
+			position = 0;
+		}
+		/**
+		 * @return Bytes written, less than size when data ran out
+		 */
+		size_t fill(uint8_t* target, size_t size)
+		{
+			size_t i = 0;
+			while (i < size)
+			{
+				if (valuePending)
+				{
+					if (position >= data.size())
+						break;
+					runValue = data[position++];
+					valuePending = false;
+				}
+				if (runLeft > 0)
+				{
+					const size_t COUNT = std::min(runLeft, size - i);
+					std::memset(target + i, runValue, COUNT);
+					i += COUNT;
+					runLeft -= COUNT;
+					continue;
+				}
+				if (position >= data.size())
+					break;
+				if (!encoded)
+				{
+					const size_t COUNT = std::min(size - i, data.size() - position);
+					std::memcpy(target + i, data.data() + position, COUNT);
+					i += COUNT;
+					position += COUNT;
+					continue;
+				}
+				const uint8_t BYTE = data[position++];
+				if (BYTE >> 6 == 3)
+				{
+					runLeft = BYTE & 0x3F;
+					valuePending = true;
+				}
+				else
+				{
+					target[i++] = BYTE;
+				}
+			}
+			return i;
+		}
+	};
 	HeaderPCX headerPCX;
-	PixelRGB* paletteVGA;
+	std::vector<PixelRGB> paletteVGA;
 	int BLUE_OFFSET;
 	int ALPHA_OFFSET;
 	void updateImage();
-	static void decodeRLE(std::ifstream& inf, std::vector<uint8_t>& imageData, const HeaderPCX& headerPCX, const uint32_t lenght);
-	static bool loadImageDataVGA(std::ifstream& stream, std::vector<uint8_t>& imageData,PagePCX& pcx, const uint32_t start, const uint32_t end);
-	static bool convertImageDataVGA(const std::vector<uint8_t>& imageData, PagePCX& pcx);
-	static bool readVGA(std::ifstream& inf, PagePCX& pcx, const uint32_t end);
-	static void writePlanarPixalData(std::ofstream& stream, const std::vector<unsigned char>& pixelData);
+	bool acceptLayout(ImageInfo& layout) override;
+	static bool decodeRLE(std::istream& inf, PixelBuffer& imageData, const HeaderPCX& headerPCX, const uint32_t lenght, int rows);
+	static bool decodeScanlines(std::istream& inf, const HeaderPCX& headerPCX, const uint32_t lenght, int firstRow, int count,
+			const std::function<void(const uint8_t*, int)>& onScanline);
+	static bool readReducedPCX(std::istream& stream, PagePCX& pcx, const uint32_t lenght, const ImageRegion& region, int factor);
+	static void setPageLayout(PagePCX& pcx, int planes, int width, int height, size_t bytesPerLine);
+	static bool readVGA(std::istream& inf, PagePCX& pcx, const uint32_t end);
+	static void encodeScanline(const uint8_t* scanline, size_t size, PixelBuffer& encoded);
 public:
-	ImagePCX(const std::string& filename);
+	ImagePCX(const std::string& filename, const LoadOptions& options = LoadOptions());
+	ImagePCX(ImagePCX&&) = default;
 	~ImagePCX();
+	ImagePCX& operator=(ImagePCX&&) = default;
 	const HeaderPCX& getHeader() const;
 	PagePCX convertToPage() const;
 	// Static functions
 	static void checkHeader(const HeaderPCX& headerPCX, const ImageInfo& image);
-	static void readHeader(std::ifstream& stream, HeaderPCX& headerPCX, ImageInfo& image);
-	static uint32_t calcFileEnd(std::ifstream& stream);
-	static bool readPCX(std::ifstream& stream, PagePCX& pcx, const uint32_t start, const uint32_t end);
-	static bool savePCX(std::ofstream& stream, const PagePCX& pcx);
+	static void readHeader(std::istream& stream, HeaderPCX& headerPCX, ImageInfo& image);
+	static uint32_t calcFileEnd(std::istream& stream);
+	/**
+	 * @param region Only this part of the page is decoded, empty means whole page
+	 * @param downscale Page is reduced by this factor (1, 2, 4 or 8) while decoding
+	 */
+	static bool readPCX(std::istream& stream, PagePCX& pcx, const uint32_t start, const uint32_t end, const ImageRegion& region = ImageRegion(),
+			int downscale = 1);
+	/**
+	 * Encodes planar pixel data, every scanline of every plane separately as the format requires.
+	 * @return Size of encoded data appended to encoded
+	 */
+	static size_t encodeImageData(const HeaderPCX& header, const PixelBuffer& pixelData, PixelBuffer& encoded);
+	/**
+	 * Encodes whole PCX file (header and pixel data) into file.
+	 * @return false when the page has unsupported number of planes
+	 */
+	static bool encodePCX(const HeaderPCX& header, const PixelBuffer& pixelData, PixelBuffer& file);
+	/**
+	 * Writes header and encoded pixel data with a single write.
+	 * @param fileSize When not nullptr, receives number of bytes written
+	 */
+	static bool savePCX(std::ofstream& stream, const HeaderPCX& header, const PixelBuffer& pixelData, size_t* fileSize = nullptr);
 	static bool isVGA(const HeaderPCX& headerPCX);
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
+	static void probeHeader(const HeaderPCX& headerPCX, ImageInfo& info);
+	/// VGA images are returned expanded to planar RGB, same as the loader does
+	static std::unique_ptr<BandReader> openBandReader(const std::string& filepath, int bandHeight = 64, const LoadOptions& options = LoadOptions());
+	/**
+	 * @param channels 2 and 4 channel images are written with 4 planes, others with 3
+	 */
+	static std::unique_ptr<BandWriter> createBandWriter(const std::string& filepath, int width, int height, int channels, std::ostream* target = nullptr);
 	// Overrides
+	ScanlineFormat getScanlineFormat() const override;
 	Pixel getPixel(int x, int y) const override;
 	void setPixel(int x, int y, Pixel newPixel) override;
 	bool saveImage() const override;
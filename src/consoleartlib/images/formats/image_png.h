@@ -2,7 +2,7 @@
 // File       : ImagePNG.h
 // Author     : riyufuchi
 // Created on : Feb 17, 2025
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -14,6 +14,7 @@
 #include <string.h>
 
 #include "../base/image.h"
+#include "../base/band_stream.h"
 //#include "../utils/stb_image.h"
 
 namespace consoleartlib
@@ -21,13 +22,22 @@ namespace consoleartlib
 class ImagePNG: public Image
 {
 public:
-	ImagePNG(const std::string& filepath);
+	ImagePNG(const std::string& filepath, const LoadOptions& options = LoadOptions());
 	ImagePNG(const std::string& filepath, int width, int height, int channels);
+	ImagePNG(ImagePNG&&) = default;
 	~ImagePNG();
+	ImagePNG& operator=(ImagePNG&&) = default;
 	virtual consoleartlib::Pixel getPixel(int x, int y) const override;
 	virtual void setPixel(int x, int y, consoleartlib::Pixel newPixel) override;
 	virtual bool saveImage() const override;
 	virtual void loadImage() override;
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
+	/**
+	 * stb has no incremental inflate, so the reader decodes the whole image on open
+	 * and the writer compresses it on finish. Only the encoded file is streamed.
+	 */
+	static std::unique_ptr<BandReader> openBandReader(const std::string& filepath, int bandHeight = 64, const LoadOptions& options = LoadOptions());
+	static std::unique_ptr<BandWriter> createBandWriter(const std::string& filepath, int width, int height, int channels, std::ostream* target = nullptr);
 };
 
 } /* namespace consoleartlib */
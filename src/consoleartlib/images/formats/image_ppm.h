@@ -2,7 +2,7 @@
 // File       : ImagePPM.h
 // Author     : riyufuchi
 // Created on : Mar 17, 2024
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2024, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -14,6 +14,7 @@
 #include <sstream>
 
 #include "../base/image.h"
+#include "../base/band_stream.h"
 
 #include "consolelib/tools/data_tools.h"
 
@@ -21,6 +22,7 @@ namespace consoleartlib
 {
 class ImagePPM : public Image
 {
+	friend class BandReaderPPM;
 private:
 	struct HeaderPPM
 	{
@@ -29,9 +31,14 @@ private:
 		int height{3};
 		short maxColorVal{255};
 	} headerPPM;
+	static TechnicalInfo readHeader(std::istream& inf, HeaderPPM& header);
+protected:
+	bool acceptLayout(ImageInfo& layout) override;
 public:
-	ImagePPM(const std::string& filename);
+	ImagePPM(const std::string& filename, const LoadOptions& options = LoadOptions());
 	ImagePPM(const std::string& filename, int width, int height);
+	ImagePPM(ImagePPM&&) = default;
+	ImagePPM& operator=(ImagePPM&&) = default;
 	~ImagePPM();
 	void virtualArtistLegacy();
 	// Overrides
@@ -39,6 +46,10 @@ public:
 	void setPixel(int x, int y, Pixel newPixel) override;
 	bool saveImage() const override;
 	void loadImage() override;
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
+	static std::unique_ptr<BandReader> openBandReader(const std::string& filepath, int bandHeight = 64, const LoadOptions& options = LoadOptions());
+	/// Bands are written as binary P6
+	static std::unique_ptr<BandWriter> createBandWriter(const std::string& filepath, int width, int height, std::ostream* target = nullptr);
 };
 } /* namespace consoleartlib */
 #endif /* IMAGES_IMAGEPPM_H_ */
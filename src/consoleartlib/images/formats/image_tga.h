@@ -2,7 +2,7 @@
 // File       : ImageTGA.h
 // Author     : riyufuchi
 // Created on : Nov 07, 2025
-// Last edit  : Dec 19, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -11,6 +11,7 @@
 #define IMAGES_IMAGETGA_H_
 
 #include "../base/image.h"
+#include "../base/band_stream.h"
 
 namespace consoleartlib
 {
@@ -18,12 +19,20 @@ namespace consoleartlib
 class ImageTGA: public Image
 {
 public:
-	ImageTGA(const std::string& filename);
+	ImageTGA(const std::string& filename, const LoadOptions& options = LoadOptions());
+	ImageTGA(ImageTGA&&) = default;
 	virtual ~ImageTGA() = default;
+	ImageTGA& operator=(ImageTGA&&) = default;
 	virtual consoleartlib::Pixel getPixel(int x, int y) const override;
 	virtual void setPixel(int x, int y, consoleartlib::Pixel newPixel) override;
 	virtual bool saveImage() const override;
 	virtual void loadImage() override;
+	static TechnicalInfo probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source = {});
+	/**
+	 * stb writes RLE compressed TGA from the whole image, so rows are collected and encoded on finish.
+	 * @param channels 1 to 4, stored as they are
+	 */
+	static std::unique_ptr<BandWriter> createBandWriter(const std::string& filepath, int width, int height, int channels, std::ostream* target = nullptr);
 };
 
 } /* namespace consoleartlib */
@@ -0,0 +1,73 @@
+//==============================================================================
+// File       : ImageFactory.h
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Creating images without knowing the concrete format class
+//==============================================================================
+
+#ifndef IMAGES_IMAGE_FACTORY_H_
+#define IMAGES_IMAGE_FACTORY_H_
+
+#include <string>
+#include <memory>
+#include <cctype>
+#include <string_view>
+#include <span>
+
+#include "../image_formats.hpp"
+
+namespace consoleartlib::image_factory
+{
+/**
+ * Recognizes format from the signature at the beginning of the file.
+ * TGA has no signature, so it is never detected here.
+ *
+ * @param header First bytes of the file, 16 are enough for every format
+ * @return ImageType::UNKNOWN when no signature matches
+ */
+ImageType detectFormat(std::span<const uint8_t> header);
+/**
+ * Reads the first bytes of the file and detects its format, falls back to the extension for TGA.
+ */
+ImageType detectFormat(const std::string& filepath);
+/**
+ * Opens image with the class matching its content, extension is not trusted.
+ *
+ * @return nullptr when the format was not recognized, otherwise image that may still fail to load (check isLoaded())
+ */
+std::unique_ptr<Image> open(const std::string& filepath, const LoadOptions& options = LoadOptions());
+/**
+ * Opens image encoded in memory. Memory must outlive the image when decoding is deferred.
+ *
+ * @param name Name of the image, it becomes its filepath
+ */
+std::unique_ptr<Image> open(std::span<const uint8_t> memory, const std::string& name, LoadOptions options = LoadOptions());
+/**
+ * Reads only the header of the file, no pixel data are decoded.
+ *
+ * @param filepath Path to the image
+ * @param type Format of the image
+ * @param info Filled with dimensions, bits, channels, palette and page info on success
+ * @return File state and message, VALID_IMAGE_FILE when the header was understood
+ */
+TechnicalInfo probe(const std::string& filepath, ImageType type, ImageInfo& info, std::span<const uint8_t> source = {});
+/**
+ * Opens image for reading in bands of rows, format is detected from the content.
+ * Supported for BMP, PCX, PPM and PNG.
+ *
+ * @return nullptr for other formats, otherwise reader that may still fail to open (check isValid())
+ */
+std::unique_ptr<BandReader> openBandReader(const std::string& filepath, int bandHeight = 64, const LoadOptions& options = LoadOptions());
+/**
+ * Creates image written in bands of rows. Supported for BMP, PCX, PPM, PNG and TGA.
+ *
+ * @param channels Channels of the image, formats round it to what they can store
+ * @param target Stream receiving the image instead of the file, filepath only names the image then
+ * @return nullptr for other formats
+ */
+std::unique_ptr<BandWriter> createBandWriter(const std::string& filepath, ImageType type, int width, int height, int channels,
+		std::ostream* target = nullptr);
+} /* namespace consoleartlib::image_factory */
+#endif /* IMAGES_IMAGE_FACTORY_H_ */
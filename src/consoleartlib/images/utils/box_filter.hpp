@@ -0,0 +1,115 @@
+//==============================================================================
+// File       : BoxFilter.hpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Integer factor downscaling of rows as they are decoded
+//==============================================================================
+
+#ifndef IMAGES_BOX_FILTER_HPP_
+#define IMAGES_BOX_FILTER_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <bit>
+#include <type_traits>
+#include <vector>
+
+namespace consoleartlib
+{
+/**
+ * @return Size of image side reduced by factor, partial blocks at the edge make a pixel too
+ */
+inline int reducedSize(int size, int factor)
+{
+	return (size + factor - 1) / factor;
+}
+/**
+ * Box filter reducing image by power of two factor. Source rows are added one at a time
+ * as decoder produces them, so only one output row of sums is kept instead of the whole image.
+ *
+ * @tparam T uint8_t for ordinary images, float for HDR
+ */
+template <typename T>
+class BoxFilter
+{
+private:
+	using Sum = std::conditional_t<std::is_floating_point_v<T>, float, uint32_t>;
+	std::vector<Sum> sums; // One per channel of every output pixel
+	int sourceWidth;
+	int channels;
+	int factor;
+	int shift;
+	int rows; // Added since last flush
+public:
+	/**
+	 * @param factor 1, 2, 4 or 8
+	 */
+	BoxFilter(int sourceWidth, int channels, int factor) : sums(static_cast<size_t>(reducedSize(sourceWidth, factor)) * channels),
+		sourceWidth(sourceWidth), channels(channels), factor(factor), shift(std::countr_zero(static_cast<unsigned>(factor))), rows(0)
+	{
+	}
+	int getWidth() const
+	{
+		return reducedSize(sourceWidth, factor);
+	}
+	/**
+	 * Sample of pixel x and channel c is at row[x * pixelStride + c * channelStride].
+	 */
+	void addRow(const T* row, ptrdiff_t pixelStride, ptrdiff_t channelStride)
+	{
+		for (int x = 0; x < sourceWidth; x++)
+		{
+			Sum* sum = sums.data() + (x >> shift) * channels;
+			for (int c = 0; c < channels; c++)
+				sum[c] += row[x * pixelStride + c * channelStride];
+		}
+		rows++;
+	}
+	void addRow(const T* row)
+	{
+		addRow(row, channels, 1);
+	}
+	/**
+	 * Writes averages of rows added since the last flush and starts the next output row.
+	 */
+	void flushRow(T* target, ptrdiff_t pixelStride, ptrdiff_t channelStride)
+	{
+		const int WIDTH = getWidth();
+		for (int x = 0; x < WIDTH; x++)
+		{
+			const Sum COUNT = static_cast<Sum>(std::min(factor, sourceWidth - x * factor) * rows);
+			const Sum* sum = sums.data() + x * channels;
+			for (int c = 0; c < channels; c++)
+			{
+				if constexpr (std::is_floating_point_v<T>)
+					target[x * pixelStride + c * channelStride] = sum[c] / COUNT;
+				else
+					target[x * pixelStride + c * channelStride] = static_cast<T>((sum[c] + COUNT / 2) / COUNT);
+			}
+		}
+		std::fill(sums.begin(), sums.end(), 0);
+		rows = 0;
+	}
+	void flushRow(T* target)
+	{
+		flushRow(target, channels, 1);
+	}
+	/**
+	 * Reduces interleaved rows given top to bottom, last block of rows may be partial.
+	 */
+	void reduce(const T* source, int sourceHeight, size_t sourceRowStride, T* target, size_t targetRowStride)
+	{
+		for (int y = 0; y < sourceHeight; y++)
+		{
+			addRow(source + y * sourceRowStride);
+			if ((y + 1) % factor == 0 || y == sourceHeight - 1)
+				flushRow(target + (y >> shift) * targetRowStride);
+		}
+	}
+};
+} /* namespace consoleartlib */
+
+#endif /* IMAGES_BOX_FILTER_HPP_ */
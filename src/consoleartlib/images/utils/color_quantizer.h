@@ -0,0 +1,66 @@
+//==============================================================================
+// File       : ColorQuantizer.h
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Reducing colors of RGBA pixels to a palette
+//==============================================================================
+
+#ifndef IMAGES_COLOR_QUANTIZER_H_
+#define IMAGES_COLOR_QUANTIZER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "pixels.hpp"
+
+namespace consoleartlib
+{
+/**
+ * Counts colors into a 15-bit histogram (5 bits per channel). When no more than maxColors distinct colors
+ * were added they become the palette as they are, otherwise median cut splits the histogram into maxColors boxes
+ * and every box is one palette color, the average of its pixels.
+ * Quantizers filled from different frames (or threads) can be merged into one palette.
+ */
+class ColorQuantizer
+{
+private:
+	static constexpr size_t BINS = 1 << 15;
+	int maxColors;
+	std::vector<uint32_t> counts;
+	std::vector<uint64_t> sums; // Red, green and blue sums of every bin
+	std::unordered_set<uint32_t> exact; // Distinct colors until there are more than maxColors of them
+	bool overflow;
+	std::vector<PixelRGB> palette;
+	std::unordered_map<uint32_t, uint8_t> exactIndexes;
+	std::vector<uint16_t> binIndexes; // Palette index of every bin after median cut
+	static size_t binOf(uint8_t red, uint8_t green, uint8_t blue)
+	{
+		return (static_cast<size_t>(red >> 3) << 10) | (static_cast<size_t>(green >> 3) << 5) | (blue >> 3);
+	}
+	void medianCut();
+public:
+	explicit ColorQuantizer(int maxColors = 256);
+	void addColor(uint8_t red, uint8_t green, uint8_t blue);
+	/**
+	 * Adds count interleaved RGBA pixels, pixels with alpha below 128 are skipped as transparent.
+	 */
+	void addPixels(const uint8_t* rgba, size_t count);
+	void merge(const ColorQuantizer& other);
+	/**
+	 * @return Palette of at most maxColors colors, empty when no color was added
+	 */
+	const std::vector<PixelRGB>& buildPalette();
+	const std::vector<PixelRGB>& getPalette() const;
+	/**
+	 * Index of palette color for a color, only valid after buildPalette().
+	 * Colors that were not added get the nearest palette color.
+	 */
+	uint8_t getIndex(uint8_t red, uint8_t green, uint8_t blue) const;
+};
+} /* namespace consoleartlib */
+#endif /* IMAGES_COLOR_QUANTIZER_H_ */
@@ -0,0 +1,65 @@
+//==============================================================================
+// File       : FrameStore.h
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Animation frames stored as keyframes and changed rectangles
+//==============================================================================
+
+#ifndef IMAGES_FRAME_STORE_H_
+#define IMAGES_FRAME_STORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include <memory_resource>
+
+#include "pixels.hpp"
+
+namespace consoleartlib
+{
+/**
+ * Keeps every keyframeInterval-th frame whole and only the rectangle that changed against
+ * the previous frame for the others, so animations moving a small sprite take a fraction of full frames.
+ * Any frame is rebuilt from the nearest keyframe before it, with at most keyframeInterval - 1 rectangles.
+ * Frames are interleaved, rows are rowStride bytes apart (padding is not compared).
+ */
+class FrameStore
+{
+private:
+	struct StoredFrame
+	{
+		int x { 0 };
+		int y { 0 };
+		int width { 0 }; // Rectangle of the frame kept in pixels, whole frame for keyframes
+		int height { 0 };
+		PixelBuffer pixels; // Rows of the rectangle packed, whole rows with padding for keyframes
+	};
+	int width;
+	int height;
+	int channels;
+	size_t rowStride;
+	size_t keyframeInterval;
+	std::vector<StoredFrame> frames;
+	PixelBuffer last; // Last added frame, changes of the next one are found against it
+	std::pmr::memory_resource* resource;
+public:
+	FrameStore(int width, int height, int channels, size_t rowStride, size_t keyframeInterval = 32,
+			std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+	/**
+	 * Appends frame after the last one.
+	 */
+	void addFrame(const uint8_t* frame);
+	/**
+	 * Rebuilds frame into target, which gets rowStride * height bytes.
+	 * @return false for index past the stored frames
+	 */
+	bool getFrame(size_t index, PixelBuffer& target) const;
+	size_t getFrameCount() const;
+	/// Bytes of stored pixels, copy of the last frame included
+	size_t getStoredBytes() const;
+	void clear();
+};
+} /* namespace consoleartlib */
+#endif /* IMAGES_FRAME_STORE_H_ */
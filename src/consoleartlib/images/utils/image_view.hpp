@@ -0,0 +1,219 @@
+//==============================================================================
+// File       : ImageView.hpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Non-owning strided window into pixel data
+//==============================================================================
+
+#ifndef IMAGES_IMAGE_VIEW_HPP_
+#define IMAGES_IMAGE_VIEW_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+#include <span>
+#include <type_traits>
+
+#include "pixels.hpp"
+#include "pixel_formats.hpp"
+
+namespace consoleartlib
+{
+/**
+ * View into pixel data owned by someone else (usually an Image).
+ * All strides are signed, so a vertically flipped view is just a pointer to the last row
+ * with negative row stride. Crops and single channel views only move the origin pointer.
+ * The view is invalidated by anything that reallocates the underlying buffer.
+ *
+ * @tparam T uint8_t for writable views, const uint8_t for read-only views
+ */
+template <typename T>
+class BasicImageView
+{
+	static_assert(std::is_same_v<std::remove_const_t<T>, uint8_t>, "Image views work with bytes only");
+private:
+	T* origin {nullptr}; // First byte of the pixel (0, 0)
+	int width {0};
+	int height {0};
+	int channels {0};
+	ptrdiff_t pixelStride {0};
+	ptrdiff_t channelStride {0};
+	ptrdiff_t rowStride {0};
+	PixelByteOrder pixelByteOrder {PixelByteOrder::RGBA};
+public:
+	BasicImageView() = default;
+	BasicImageView(T* origin, int width, int height, int channels, ptrdiff_t pixelStride, ptrdiff_t channelStride, ptrdiff_t rowStride,
+			PixelByteOrder pixelByteOrder = PixelByteOrder::RGBA) : origin(origin), width(width), height(height), channels(channels),
+			pixelStride(pixelStride), channelStride(channelStride), rowStride(rowStride), pixelByteOrder(pixelByteOrder)
+	{
+	}
+	BasicImageView(T* origin, int width, int height, const ScanlineFormat& format) : BasicImageView(origin, width, height, format.channels,
+			format.pixelStride, format.channelStride, format.rowStride, format.pixelByteOrder)
+	{
+	}
+	// Writable view can always be used as read-only one
+	operator BasicImageView<const uint8_t>() const requires (!std::is_const_v<T>)
+	{
+		return BasicImageView<const uint8_t>(origin, width, height, channels, pixelStride, channelStride, rowStride, pixelByteOrder);
+	}
+	explicit operator bool() const
+	{
+		return origin && width > 0 && height > 0;
+	}
+	// Getters
+	T* data() const { return origin; }
+	int getWidth() const { return width; }
+	int getHeight() const { return height; }
+	int getChannels() const { return channels; }
+	ptrdiff_t getPixelStride() const { return pixelStride; }
+	ptrdiff_t getChannelStride() const { return channelStride; }
+	ptrdiff_t getRowStride() const { return rowStride; }
+	PixelByteOrder getPixelByteOrder() const { return pixelByteOrder; }
+	bool isPlanar() const { return channels > 1 && channelStride != 1; }
+	/// True when one row of the view is a single contiguous run of bytes
+	bool isRowContiguous() const { return channelStride == 1 && pixelStride == channels; }
+	T* row(int y) const { return origin + y * rowStride; }
+	T* at(int x, int y) const { return origin + y * rowStride + x * pixelStride; }
+	T& at(int x, int y, int channel) const { return origin[y * rowStride + x * pixelStride + channel * channelStride]; }
+	// Derived views
+	BasicImageView crop(int x, int y, int cropWidth, int cropHeight) const
+	{
+		x = std::clamp(x, 0, width);
+		y = std::clamp(y, 0, height);
+		cropWidth = std::clamp(cropWidth, 0, width - x);
+		cropHeight = std::clamp(cropHeight, 0, height - y);
+		BasicImageView view = *this;
+		view.origin = at(x, y);
+		view.width = cropWidth;
+		view.height = cropHeight;
+		return view;
+	}
+	BasicImageView flipVertical() const
+	{
+		BasicImageView view = *this;
+		if (height > 0)
+			view.origin = row(height - 1);
+		view.rowStride = -rowStride;
+		return view;
+	}
+	BasicImageView flipHorizontal() const
+	{
+		BasicImageView view = *this;
+		if (width > 0)
+			view.origin = at(width - 1, 0);
+		view.pixelStride = -pixelStride;
+		return view;
+	}
+	/**
+	 * @param index Channel in memory order (for BGRA data 0 is blue)
+	 * @return Single channel (grayscale) view
+	 */
+	BasicImageView channel(int index) const
+	{
+		BasicImageView view = *this;
+		view.origin = (index >= 0 && index < channels) ? origin + index * channelStride : nullptr;
+		view.channels = 1;
+		view.channelStride = 1;
+		return view;
+	}
+	// Pixel access
+	Pixel getPixel(int x, int y) const
+	{
+		Pixel pixel;
+		readRow(y, std::span<Pixel>(&pixel, 1), x);
+		return pixel;
+	}
+	void setPixel(int x, int y, Pixel pixel) const requires (!std::is_const_v<T>)
+	{
+		writeRow(y, std::span<const Pixel>(&pixel, 1), x);
+	}
+	/**
+	 * Calls kernel with compile-time description of this view's layout, see pixel_formats::dispatch.
+	 */
+	template <typename Kernel>
+	decltype(auto) dispatch(Kernel&& kernel) const
+	{
+		return pixel_formats::dispatch(channels, pixelByteOrder, pixelStride, channelStride, std::forward<Kernel>(kernel));
+	}
+	/**
+	 * Converts pixels of one row starting at column x. Layout is resolved once per call,
+	 * the inner loop is specialized for it.
+	 */
+	void readRow(int y, std::span<Pixel> pixels, int x = 0) const
+	{
+		const T* src = at(x, y);
+		const size_t count = std::min(pixels.size(), static_cast<size_t>(std::max(width - x, 0)));
+		dispatch([&](const auto format)
+		{
+			const ptrdiff_t STEP = format.step();
+			for (size_t i = 0; i < count; i++)
+				pixels[i] = format.load(src + i * STEP);
+		});
+	}
+	void writeRow(int y, std::span<const Pixel> pixels, int x = 0) const requires (!std::is_const_v<T>)
+	{
+		T* dst = at(x, y);
+		const size_t count = std::min(pixels.size(), static_cast<size_t>(std::max(width - x, 0)));
+		dispatch([&](const auto format)
+		{
+			const ptrdiff_t STEP = format.step();
+			for (size_t i = 0; i < count; i++)
+				format.store(dst + i * STEP, pixels[i]);
+		});
+	}
+};
+
+using ImageView = BasicImageView<uint8_t>;
+using ConstImageView = BasicImageView<const uint8_t>;
+
+/**
+ * Copies pixels between two views of the same size, converting layout when needed.
+ * Rows with identical contiguous layout are copied with memcpy.
+ * @return false when dimensions differ
+ */
+inline bool copyPixels(const ConstImageView& source, const ImageView& target)
+{
+	if (source.getWidth() != target.getWidth() || source.getHeight() != target.getHeight())
+		return false;
+	const int WIDTH = source.getWidth();
+	if (source.isRowContiguous() && target.isRowContiguous() && source.getChannels() == target.getChannels() &&
+		(source.getPixelByteOrder() == target.getPixelByteOrder() || source.getChannels() < 3))
+	{
+		const size_t ROW_SIZE = static_cast<size_t>(WIDTH) * source.getChannels();
+		for (int y = 0; y < source.getHeight(); y++)
+			std::memmove(target.row(y), source.row(y), ROW_SIZE);
+		return true;
+	}
+	if (source.getChannels() == target.getChannels() && source.getChannels() < 3)
+	{
+		// Gray data need no color conversion, so only strides are followed
+		for (int y = 0; y < source.getHeight(); y++)
+			for (int x = 0; x < WIDTH; x++)
+				for (int c = 0; c < source.getChannels(); c++)
+					target.at(x, y, c) = source.at(x, y, c);
+		return true;
+	}
+	// Kernel is instantiated for every pair of layouts, pixels go straight from one to the other
+	source.dispatch([&](const auto from)
+	{
+		target.dispatch([&](const auto to)
+		{
+			const ptrdiff_t FROM_STEP = from.step();
+			const ptrdiff_t TO_STEP = to.step();
+			for (int y = 0; y < source.getHeight(); y++)
+			{
+				const uint8_t* src = source.row(y);
+				uint8_t* dst = target.row(y);
+				for (int x = 0; x < WIDTH; x++)
+					to.store(dst + x * TO_STEP, from.load(src + x * FROM_STEP));
+			}
+		});
+	});
+	return true;
+}
+} /* namespace consoleartlib */
+
+#endif /* IMAGES_IMAGE_VIEW_HPP_ */
@@ -0,0 +1,45 @@
+//==============================================================================
+// File       : MappedFile.h
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Read-only memory mapping of a whole file
+//==============================================================================
+
+#ifndef IMAGES_MAPPED_FILE_H_
+#define IMAGES_MAPPED_FILE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+namespace consoleartlib
+{
+/**
+ * Maps a file into memory, so decoders can read it in place without copying it into stream buffers.
+ * Mapping is supported on Linux only, elsewhere map() fails and the caller reads the file the usual way.
+ */
+class MappedFile
+{
+private:
+	void* address;
+	size_t length;
+public:
+	MappedFile();
+	MappedFile(const MappedFile&) = delete;
+	MappedFile(MappedFile&& other) noexcept;
+	~MappedFile();
+	MappedFile& operator=(const MappedFile&) = delete;
+	MappedFile& operator=(MappedFile&& other) noexcept;
+	/**
+	 * @return false when the file can't be mapped (missing, empty, or mapping not supported)
+	 */
+	bool map(const std::string& filepath);
+	void unmap();
+	bool isMapped() const;
+	std::span<const uint8_t> getData() const;
+};
+} /* namespace consoleartlib */
+#endif /* IMAGES_MAPPED_FILE_H_ */
@@ -0,0 +1,133 @@
+//==============================================================================
+// File       : MemoryResources.h
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Memory resources for pixel buffers
+//==============================================================================
+
+#ifndef IMAGES_MEMORY_RESOURCES_H_
+#define IMAGES_MEMORY_RESOURCES_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <vector>
+#include <memory_resource>
+
+namespace consoleartlib
+{
+/**
+ * Bump allocator for batch jobs. Deallocation does nothing, reset() makes the whole arena
+ * free again while keeping its chunks, so the next batch reuses already touched memory.
+ * Not thread safe.
+ */
+class ArenaResource : public std::pmr::memory_resource
+{
+private:
+	struct Chunk
+	{
+		std::byte* data;
+		size_t size;
+	};
+	std::pmr::memory_resource* upstream;
+	size_t chunkSize;
+	std::vector<Chunk> chunks;
+	size_t currentChunk;
+	size_t used; // Bytes used in current chunk
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+public:
+	ArenaResource(size_t chunkSize = 64 << 20, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+	ArenaResource(const ArenaResource&) = delete;
+	ArenaResource& operator=(const ArenaResource&) = delete;
+	~ArenaResource();
+	/// Every allocation made so far becomes invalid, chunks are kept for reuse
+	void reset();
+	/// Returns all chunks to upstream resource
+	void release();
+	size_t getCapacity() const;
+};
+/**
+ * Keeps freed buffers and hands them out again for requests of similar size,
+ * so loading many images of the same dimensions allocates only once. Thread safe.
+ */
+class BufferPoolResource : public std::pmr::memory_resource
+{
+private:
+	std::pmr::memory_resource* upstream;
+	size_t maxCachedBytes;
+	size_t cachedBytes;
+	std::multimap<size_t, void*> freeBuffers; // Capacity -> buffer
+	std::map<void*, size_t> capacities; // Buffer -> capacity of all buffers handed out
+	std::mutex mutex;
+	static constexpr size_t BUFFER_ALIGNMENT = 64; // Every pooled buffer has it, so any of them fits any request
+	static size_t roundCapacity(size_t bytes);
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+public:
+	/**
+	 * @param maxCachedBytes Freed buffers above this total are returned to upstream immediately
+	 */
+	BufferPoolResource(size_t maxCachedBytes = 512 << 20, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+	BufferPoolResource(const BufferPoolResource&) = delete;
+	BufferPoolResource& operator=(const BufferPoolResource&) = delete;
+	~BufferPoolResource();
+	/// Returns cached buffers to upstream resource, buffers in use are not affected
+	void release();
+	size_t getCachedBytes();
+};
+/**
+ * Raises alignment of every allocation, so buffers start on cache line (or SIMD register) boundary.
+ */
+class AlignedResource : public std::pmr::memory_resource
+{
+private:
+	std::pmr::memory_resource* upstream;
+	size_t alignment;
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+public:
+	AlignedResource(size_t alignment = 64, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+	std::pmr::memory_resource* getUpstream() const;
+	/**
+	 * Shared adaptor for given upstream and alignment. Adaptors live until the program ends,
+	 * so images can move between owners without dangling resources.
+	 *
+	 * @param alignment Power of two
+	 */
+	static std::pmr::memory_resource* of(std::pmr::memory_resource* upstream, size_t alignment);
+};
+/**
+ * Large buffers are mapped directly and backed by transparent huge pages where the system supports them,
+ * so touching a big image causes one page fault per 2 MiB instead of one per 4 KiB.
+ * Small allocations go to upstream resource.
+ */
+class HugePageResource : public std::pmr::memory_resource
+{
+private:
+	std::pmr::memory_resource* upstream;
+	size_t threshold;
+	bool populate;
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void* p, size_t bytes, size_t alignment) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+public:
+	static constexpr size_t HUGE_PAGE_SIZE = 2 << 20;
+	/**
+	 * @param threshold Allocations from this size use huge pages
+	 * @param populate Fault all pages in during allocation (Linux only)
+	 */
+	HugePageResource(size_t threshold = HUGE_PAGE_SIZE, bool populate = false, std::pmr::memory_resource* upstream = std::pmr::get_default_resource());
+};
+} /* namespace consoleartlib */
+#endif /* IMAGES_MEMORY_RESOURCES_H_ */
@@ -0,0 +1,143 @@
+//==============================================================================
+// File       : PaletteLUT.hpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Expanding rows of palette indexes for indexed formats
+//==============================================================================
+
+#ifndef IMAGES_PALETTE_LUT_HPP_
+#define IMAGES_PALETTE_LUT_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <span>
+
+#if defined(__AVX2__)
+	#include <immintrin.h>
+#endif
+
+#include "pixels.hpp"
+
+namespace consoleartlib
+{
+/**
+ * Palette of 256 colors packed to one 32-bit word per entry (red in the lowest byte, alpha in the highest),
+ * so a whole row of indexes is expanded with one table load per pixel. With AVX2 eight pixels
+ * are gathered at once and shuffled straight to planar or interleaved layout.
+ * Indexes past the end of a short palette give opaque black.
+ */
+class PaletteLUT
+{
+private:
+	alignas(32) uint32_t packed[256];
+	static constexpr uint32_t pack(uint8_t red, uint8_t green, uint8_t blue, uint8_t alpha)
+	{
+		return red | (green << 8) | (blue << 16) | (static_cast<uint32_t>(alpha) << 24);
+	}
+#if defined(__AVX2__)
+	__m256i gather(const uint8_t* indexes) const
+	{
+		const __m256i INDEXES = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(indexes)));
+		return _mm256_i32gather_epi32(reinterpret_cast<const int*>(packed), INDEXES, 4);
+	}
+#endif
+public:
+	PaletteLUT()
+	{
+		for (uint32_t& entry : packed)
+			entry = pack(0, 0, 0, 255);
+	}
+	explicit PaletteLUT(std::span<const PixelRGB> palette) : PaletteLUT()
+	{
+		for (size_t i = 0; i < palette.size() && i < 256; i++)
+			packed[i] = pack(palette[i].red, palette[i].green, palette[i].blue, 255);
+	}
+	void setEntry(uint8_t index, const Pixel& color)
+	{
+		packed[index] = pack(color.red, color.green, color.blue, color.alpha);
+	}
+	Pixel operator[](uint8_t index) const
+	{
+		const uint32_t ENTRY = packed[index];
+		return {static_cast<uint8_t>(ENTRY), static_cast<uint8_t>(ENTRY >> 8), static_cast<uint8_t>(ENTRY >> 16), static_cast<uint8_t>(ENTRY >> 24)};
+	}
+	/**
+	 * Writes count pixels to three separate planes (PCX layout).
+	 */
+	void expandPlanar(const uint8_t* indexes, size_t count, uint8_t* red, uint8_t* green, uint8_t* blue) const
+	{
+		size_t x = 0;
+	#if defined(__AVX2__)
+		// Bytes of each channel are grouped in every lane, then the lanes are merged to 8 bytes per channel
+		const __m256i GROUP = _mm256_setr_epi8(0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15,
+			0, 4, 8, 12, 1, 5, 9, 13, 2, 6, 10, 14, 3, 7, 11, 15);
+		const __m256i MERGE = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		for (; x + 8 <= count; x += 8)
+		{
+			const __m256i PLANES = _mm256_permutevar8x32_epi32(_mm256_shuffle_epi8(gather(indexes + x), GROUP), MERGE);
+			const int64_t R = _mm256_extract_epi64(PLANES, 0);
+			const int64_t G = _mm256_extract_epi64(PLANES, 1);
+			const int64_t B = _mm256_extract_epi64(PLANES, 2);
+			std::memcpy(red + x, &R, 8);
+			std::memcpy(green + x, &G, 8);
+			std::memcpy(blue + x, &B, 8);
+		}
+	#endif
+		for (; x < count; x++)
+		{
+			const uint32_t ENTRY = packed[indexes[x]];
+			red[x] = static_cast<uint8_t>(ENTRY);
+			green[x] = static_cast<uint8_t>(ENTRY >> 8);
+			blue[x] = static_cast<uint8_t>(ENTRY >> 16);
+		}
+	}
+	/**
+	 * Writes count pixels interleaved.
+	 * @param channels 3 (alpha is dropped) or 4
+	 */
+	void expandInterleaved(const uint8_t* indexes, size_t count, uint8_t* target, int channels, PixelByteOrder order = PixelByteOrder::RGBA) const
+	{
+		size_t x = 0;
+	#if defined(__AVX2__)
+		const __m256i ORDER = (order == PixelByteOrder::BGRA) ?
+			_mm256_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15, 2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15) :
+			_mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+		// Drops alpha, every lane then holds 12 bytes of color
+		const __m256i PACK3 = (order == PixelByteOrder::BGRA) ?
+			_mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1) :
+			_mm256_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1, 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+		if (channels == 4)
+		{
+			for (; x + 8 <= count; x += 8)
+				_mm256_storeu_si256(reinterpret_cast<__m256i*>(target + x * 4), _mm256_shuffle_epi8(gather(indexes + x), ORDER));
+		}
+		else
+		{
+			alignas(32) uint8_t pixels[32];
+			for (; x + 8 <= count; x += 8)
+			{
+				_mm256_store_si256(reinterpret_cast<__m256i*>(pixels), _mm256_shuffle_epi8(gather(indexes + x), PACK3));
+				std::memcpy(target + x * 3, pixels, 12);
+				std::memcpy(target + x * 3 + 12, pixels + 16, 12);
+			}
+		}
+	#endif
+		const int R = (order == PixelByteOrder::BGRA) ? 2 : 0;
+		for (; x < count; x++)
+		{
+			const uint32_t ENTRY = packed[indexes[x]];
+			uint8_t* pixel = target + x * channels;
+			pixel[R] = static_cast<uint8_t>(ENTRY);
+			pixel[1] = static_cast<uint8_t>(ENTRY >> 8);
+			pixel[2 - R] = static_cast<uint8_t>(ENTRY >> 16);
+			if (channels == 4)
+				pixel[3] = static_cast<uint8_t>(ENTRY >> 24);
+		}
+	}
+};
+} /* namespace consoleartlib */
+
+#endif /* IMAGES_PALETTE_LUT_HPP_ */
@@ -0,0 +1,92 @@
+//==============================================================================
+// File       : Parallel.hpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Running independent tasks (pages, frames) on several threads
+//==============================================================================
+
+#ifndef IMAGES_PARALLEL_HPP_
+#define IMAGES_PARALLEL_HPP_
+
+#include <cstddef>
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+namespace consoleartlib
+{
+/**
+ * @param requested 0 means one thread per hardware thread
+ * @return Number of workers worth starting for count tasks
+ */
+inline unsigned workerCount(unsigned requested, size_t count)
+{
+	unsigned threads = requested ? requested : std::max(std::thread::hardware_concurrency(), 1u);
+	return static_cast<unsigned>(std::min<size_t>(threads, count));
+}
+/**
+ * Calls task(i) for every i in [0, count). Indexes are handed out one at a time, so tasks of uneven size
+ * (pages, frames) balance themselves. Calling thread works too, with one worker nothing is started.
+ * First exception thrown by a task is rethrown after all workers finished, remaining tasks are skipped.
+ * When a thread can't be started, tasks are shared by the workers started so far.
+ *
+ * @param threads 0 means one thread per hardware thread
+ */
+template <typename Task>
+void parallelFor(size_t count, Task&& task, unsigned threads = 0)
+{
+	const unsigned WORKERS = workerCount(threads, count);
+	if (WORKERS <= 1)
+	{
+		for (size_t i = 0; i < count; i++)
+			task(i);
+		return;
+	}
+	std::atomic<size_t> next {0};
+	std::exception_ptr failure;
+	std::mutex failureMutex;
+	auto work = [&]()
+	{
+		for (size_t i = next++; i < count; i = next++)
+		{
+			try
+			{
+				task(i);
+			}
+			catch (...)
+			{
+				std::lock_guard<std::mutex> lock(failureMutex);
+				if (!failure)
+					failure = std::current_exception();
+				next = count;
+			}
+		}
+	};
+	std::vector<std::thread> workers;
+	workers.reserve(WORKERS - 1);
+	for (unsigned i = 1; i < WORKERS; i++)
+	{
+		try
+		{
+			workers.emplace_back(work);
+		}
+		catch (const std::system_error&)
+		{
+			break; // Calling thread takes whatever is left
+		}
+	}
+	work();
+	for (std::thread& worker : workers)
+		worker.join();
+	if (failure)
+		std::rethrow_exception(failure);
+}
+} /* namespace consoleartlib */
+
+#endif /* IMAGES_PARALLEL_HPP_ */
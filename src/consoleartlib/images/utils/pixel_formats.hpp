@@ -0,0 +1,237 @@
+//==============================================================================
+// File       : PixelFormats.hpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Compile-time pixel layouts and dispatching kernels to them
+//==============================================================================
+
+#ifndef IMAGES_PIXEL_FORMATS_HPP_
+#define IMAGES_PIXEL_FORMATS_HPP_
+
+#include <cstdint>
+#include <cstddef>
+#include <utility>
+
+#include "pixels.hpp"
+
+/**
+ * Every format knows at compile time where its channels are, so a kernel instantiated
+ * for it has no channel or byte order branches in the inner loop.
+ * Format interface:
+ *   CHANNELS      - number of channels
+ *   step()        - bytes between two neighboring pixels
+ *   load(pointer) - reads pixel, missing channels are filled (gray to RGB, alpha 255)
+ *   store(pointer, pixel) - writes pixel, RGB to gray uses integer luminance
+ */
+namespace consoleartlib::pixel_formats
+{
+constexpr uint8_t luminance(const Pixel& pixel)
+{
+	return (pixel.red * 77 + pixel.green * 150 + pixel.blue * 29) >> 8;
+}
+/**
+ * Tightly packed interleaved 8-bit channels
+ */
+template <int CH, PixelByteOrder ORDER = PixelByteOrder::RGBA>
+struct Interleaved8
+{
+	static constexpr int CHANNELS = CH;
+	static constexpr int R = (ORDER == PixelByteOrder::BGRA) ? 2 : 0;
+	static constexpr int B = 2 - R;
+	static constexpr ptrdiff_t step() { return CH; }
+	static Pixel load(const uint8_t* p)
+	{
+		if constexpr (CH == 1)
+			return {p[0], p[0], p[0]};
+		else if constexpr (CH == 2)
+			return {p[0], p[0], p[0], p[1]};
+		else if constexpr (CH == 3)
+			return {p[R], p[1], p[B]};
+		else
+			return {p[R], p[1], p[B], p[3]};
+	}
+	static void store(uint8_t* p, const Pixel& pixel)
+	{
+		if constexpr (CH <= 2)
+		{
+			p[0] = luminance(pixel);
+			if constexpr (CH == 2)
+				p[1] = pixel.alpha;
+		}
+		else
+		{
+			p[R] = pixel.red;
+			p[1] = pixel.green;
+			p[B] = pixel.blue;
+			if constexpr (CH == 4)
+				p[3] = pixel.alpha;
+		}
+	}
+};
+using Gray8 = Interleaved8<1>;
+using GrayAlpha8 = Interleaved8<2>;
+using RGB8 = Interleaved8<3>;
+using RGBA8 = Interleaved8<4>;
+using BGR8 = Interleaved8<3, PixelByteOrder::BGRA>;
+using BGRA8 = Interleaved8<4, PixelByteOrder::BGRA>;
+/**
+ * One plane per channel (PCX), plane distance is known only at runtime
+ */
+template <int CH>
+struct Planar8
+{
+	static constexpr int CHANNELS = CH;
+	ptrdiff_t channelStride;
+	static constexpr ptrdiff_t step() { return 1; }
+	Pixel load(const uint8_t* p) const
+	{
+		if constexpr (CH == 3)
+			return {p[0], p[channelStride], p[2 * channelStride]};
+		else
+			return {p[0], p[channelStride], p[2 * channelStride], p[3 * channelStride]};
+	}
+	void store(uint8_t* p, const Pixel& pixel) const
+	{
+		p[0] = pixel.red;
+		p[channelStride] = pixel.green;
+		p[2 * channelStride] = pixel.blue;
+		if constexpr (CH == 4)
+			p[3 * channelStride] = pixel.alpha;
+	}
+};
+using PlanarRGB8 = Planar8<3>;
+using PlanarRGBA8 = Planar8<4>;
+/**
+ * Anything else (mirrored or single channel views), every stride is resolved at runtime
+ */
+struct Strided8
+{
+	int channels;
+	ptrdiff_t pixelStride;
+	ptrdiff_t channelStride;
+	ptrdiff_t R;
+	ptrdiff_t B;
+	Strided8(int channels, PixelByteOrder order, ptrdiff_t pixelStride, ptrdiff_t channelStride) : channels(channels),
+		pixelStride(pixelStride), channelStride(channelStride), R((order == PixelByteOrder::BGRA) ? 2 * channelStride : 0), B(2 * channelStride - R)
+	{
+	}
+	ptrdiff_t step() const { return pixelStride; }
+	Pixel load(const uint8_t* p) const
+	{
+		switch (channels)
+		{
+			case 1: return {p[0], p[0], p[0]};
+			case 2: return {p[0], p[0], p[0], p[channelStride]};
+			case 3: return {p[R], p[channelStride], p[B]};
+			default: return {p[R], p[channelStride], p[B], p[3 * channelStride]};
+		}
+	}
+	void store(uint8_t* p, const Pixel& pixel) const
+	{
+		if (channels <= 2)
+		{
+			p[0] = luminance(pixel);
+			if (channels == 2)
+				p[channelStride] = pixel.alpha;
+			return;
+		}
+		p[R] = pixel.red;
+		p[channelStride] = pixel.green;
+		p[B] = pixel.blue;
+		if (channels > 3)
+			p[3 * channelStride] = pixel.alpha;
+	}
+};
+/**
+ * Interleaved 32-bit float channels (HDR)
+ */
+template <int CH>
+struct InterleavedF32
+{
+	static constexpr int CHANNELS = CH;
+	static constexpr ptrdiff_t step() { return CH; }
+	static PixelHDR load(const float* p)
+	{
+		if constexpr (CH == 1)
+			return {p[0], p[0], p[0]};
+		else if constexpr (CH == 2)
+			return {p[0], p[0], p[0], p[1]};
+		else if constexpr (CH == 3)
+			return {p[0], p[1], p[2]};
+		else
+			return {p[0], p[1], p[2], p[3]};
+	}
+	static void store(float* p, const PixelHDR& pixel)
+	{
+		if constexpr (CH <= 2)
+		{
+			p[0] = 0.299f * pixel.red + 0.587f * pixel.green + 0.114f * pixel.blue;
+			if constexpr (CH == 2)
+				p[1] = pixel.alpha;
+		}
+		else
+		{
+			p[0] = pixel.red;
+			p[1] = pixel.green;
+			p[2] = pixel.blue;
+			if constexpr (CH == 4)
+				p[3] = pixel.alpha;
+		}
+	}
+};
+using RGBF32 = InterleavedF32<3>;
+using RGBAF32 = InterleavedF32<4>;
+/**
+ * Calls kernel with the format object matching the layout. Every kernel is instantiated
+ * for all formats, so the layout decision happens once per call instead of once per pixel.
+ *
+ * @param kernel Generic callable taking the format as its only argument
+ * @return Whatever the kernel returns
+ */
+template <typename Kernel>
+decltype(auto) dispatch(int channels, PixelByteOrder order, ptrdiff_t pixelStride, ptrdiff_t channelStride, Kernel&& kernel)
+{
+	const bool BGR = (order == PixelByteOrder::BGRA);
+	if (channelStride == 1 && pixelStride == channels)
+	{
+		switch (channels)
+		{
+			case 1: return std::forward<Kernel>(kernel)(Gray8());
+			case 2: return std::forward<Kernel>(kernel)(GrayAlpha8());
+			case 3: return BGR ? std::forward<Kernel>(kernel)(BGR8()) : std::forward<Kernel>(kernel)(RGB8());
+			case 4: return BGR ? std::forward<Kernel>(kernel)(BGRA8()) : std::forward<Kernel>(kernel)(RGBA8());
+		}
+	}
+	else if (pixelStride == 1 && !BGR && channelStride > 1)
+	{
+		if (channels == 3)
+			return std::forward<Kernel>(kernel)(PlanarRGB8{channelStride});
+		if (channels == 4)
+			return std::forward<Kernel>(kernel)(PlanarRGBA8{channelStride});
+	}
+	return std::forward<Kernel>(kernel)(Strided8(channels, order, pixelStride, channelStride));
+}
+template <typename Kernel>
+decltype(auto) dispatch(const ScanlineFormat& format, Kernel&& kernel)
+{
+	return dispatch(format.channels, format.pixelByteOrder, format.pixelStride, format.channelStride, std::forward<Kernel>(kernel));
+}
+/**
+ * Float variant of dispatch for HDR data.
+ */
+template <typename Kernel>
+decltype(auto) dispatchHDR(int channels, Kernel&& kernel)
+{
+	switch (channels)
+	{
+		case 1: return std::forward<Kernel>(kernel)(InterleavedF32<1>());
+		case 2: return std::forward<Kernel>(kernel)(InterleavedF32<2>());
+		case 3: return std::forward<Kernel>(kernel)(RGBF32());
+		default: return std::forward<Kernel>(kernel)(RGBAF32());
+	}
+}
+} /* namespace consoleartlib::pixel_formats */
+
+#endif /* IMAGES_PIXEL_FORMATS_HPP_ */
@@ -2,7 +2,7 @@
 // File       : Pixels.hpp
 // Author     : riyufuchi
 // Created on : Mar 24, 2024
-// Last edit  : Mar 24, 2024
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2024, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -11,6 +11,9 @@
 #define IMAGES_PIXELS_HPP_
 
 #include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <memory_resource>
 
 namespace consoleartlib
 {
@@ -19,6 +22,8 @@ enum PixelByteOrder
 	RGBA,
 	BGRA
 };
+/// Pixel bytes, allocated from memory resource chosen when the image is loaded
+using PixelBuffer = std::pmr::vector<uint8_t>;
 struct PixelRGB
 {
 	uint8_t red;
@@ -39,5 +44,19 @@ struct Pixel
 	uint8_t blue;
 	uint8_t alpha {255};
 };
+/**
+ * Describes how one scanline is laid out in memory.
+ * Interleaved data have pixelStride == channels and channelStride == 1,
+ * planar data (PCX) have pixelStride == 1 and channelStride == size of one plane.
+ */
+struct ScanlineFormat
+{
+	int channels {3};
+	PixelByteOrder pixelByteOrder {PixelByteOrder::RGBA};
+	size_t pixelStride {3}; // Bytes between two neighboring pixels
+	size_t channelStride {1}; // Bytes between two channels of the same pixel
+	size_t rowStride {0}; // Bytes between two scanlines
+	bool isPlanar() const { return channels > 1 && channelStride != 1; }
+};
 }
 #endif /* IMAGES_PIXELS_HPP_ */
@@ -0,0 +1,121 @@
+//==============================================================================
+// File       : SourceStream.hpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Input stream reading encoded image from file or from memory
+//==============================================================================
+
+#ifndef IMAGES_SOURCE_STREAM_HPP_
+#define IMAGES_SOURCE_STREAM_HPP_
+
+#include <cstdint>
+#include <istream>
+#include <fstream>
+#include <algorithm>
+#include <span>
+#include <string>
+
+#include "pixels.hpp"
+#include "mapped_file.h"
+
+namespace consoleartlib
+{
+/**
+ * Read-only stream buffer over bytes owned by someone else. Supports seeking,
+ * so decoders can jump to offsets the same way they do in files.
+ */
+class MemoryStreamBuffer : public std::streambuf
+{
+public:
+	MemoryStreamBuffer() = default;
+	MemoryStreamBuffer(std::span<const uint8_t> memory)
+	{
+		char* begin = const_cast<char*>(reinterpret_cast<const char*>(memory.data()));
+		setg(begin, begin, begin + memory.size());
+	}
+protected:
+	pos_type seekoff(off_type offset, std::ios_base::seekdir dir, std::ios_base::openmode which = std::ios_base::in) override
+	{
+		if (!(which & std::ios_base::in))
+			return pos_type(off_type(-1));
+		off_type base = 0;
+		if (dir == std::ios_base::cur)
+			base = gptr() - eback();
+		else if (dir == std::ios_base::end)
+			base = egptr() - eback();
+		return seekpos(pos_type(base + offset), which);
+	}
+	pos_type seekpos(pos_type position, std::ios_base::openmode which = std::ios_base::in) override
+	{
+		const off_type offset = off_type(position);
+		if (!(which & std::ios_base::in) || offset < 0 || offset > egptr() - eback())
+			return pos_type(off_type(-1));
+		setg(eback(), eback() + offset, egptr());
+		return position;
+	}
+public:
+	/**
+	 * Hands out up to count bytes from the current position without copying them and moves past them.
+	 */
+	std::span<const uint8_t> take(size_t count)
+	{
+		count = std::min(count, static_cast<size_t>(egptr() - gptr()));
+		const uint8_t* data = reinterpret_cast<const uint8_t*>(gptr());
+		setg(eback(), gptr() + count, egptr()); // gbump() takes int, blocks may be larger
+		return std::span<const uint8_t>(data, count);
+	}
+};
+/**
+ * Binary input stream for decoders. Reads the given memory when it is not empty, otherwise the file at path.
+ * Files are memory mapped when possible and read through a file buffer when not.
+ * Failing to open the file leaves the stream in failed state, same as std::ifstream.
+ */
+class SourceStream : public std::istream
+{
+private:
+	std::filebuf file;
+	MappedFile mapping;
+	MemoryStreamBuffer memory;
+public:
+	SourceStream(const std::string& filepath, std::span<const uint8_t> source = {}) : std::istream(nullptr)
+	{
+		if (source.empty() && mapping.map(filepath))
+			source = mapping.getData();
+		if (!source.empty())
+		{
+			memory = MemoryStreamBuffer(source);
+			rdbuf(&memory);
+		}
+		else if (file.open(filepath, std::ios::in | std::ios::binary))
+		{
+			rdbuf(&file);
+		}
+	}
+	bool isMemory() const
+	{
+		return rdbuf() == &memory;
+	}
+};
+/**
+ * Reads next count bytes of the stream. Memory backed streams (mapped files included) return
+ * the bytes in place, other streams read them into the scratch buffer.
+ * @return Fewer bytes than requested when the stream ends sooner
+ */
+inline std::span<const uint8_t> readBlock(std::istream& stream, size_t count, PixelBuffer& scratch)
+{
+	if (MemoryStreamBuffer* memory = dynamic_cast<MemoryStreamBuffer*>(stream.rdbuf()))
+	{
+		const std::span<const uint8_t> block = memory->take(count);
+		if (block.size() < count)
+			stream.setstate(std::ios::eofbit | std::ios::failbit);
+		return block;
+	}
+	scratch.resize(count);
+	stream.read(reinterpret_cast<char*>(scratch.data()), count);
+	return std::span<const uint8_t>(scratch.data(), static_cast<size_t>(stream.gcount()));
+}
+} /* namespace consoleartlib */
+
+#endif /* IMAGES_SOURCE_STREAM_HPP_ */
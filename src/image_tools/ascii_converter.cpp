@@ -2,7 +2,7 @@
 // Name        : AsciiConverter
 // Author      : Riyufuchi
 // Created on  : Nov 15, 2022 (Functionality from class ImageBMP)
-// Last Edit   : Mar 27, 2024
+// Last Edit   : Oct 17, 2026
 // Description : This class converts bitmap image to ASCII/desired char set
 //============================================================================
 
@@ -146,20 +146,19 @@ bool AsciiConverter::convertToASCII()
 	if (!sourceImg)
 		return false;
 	std::string line = "";
-	consoleartlib::Pixel pix;
 	const int HEIGHT = sourceImg.getImageInfo().height;
 	const int WIDTH = sourceImg.getImageInfo().width;
-	int x = 0;
 	int charID = 0;
 	int index = 0;
 	const int DEF_BRIGHTNESS_DIFF = brightnessDiff;
 	const int CHARSET_SIZE = chars.size() - 1;
+	std::vector<consoleartlib::Pixel> row(WIDTH);
 	ASCII_image = new std::string[HEIGHT];
 	for(int y = 0; y < HEIGHT; y++)
 	{
-		for (x = 0; x < WIDTH; x++)
+		sourceImg.readScanline(y, row);
+		for (const consoleartlib::Pixel& pix : row)
 		{
-			pix = sourceImg.getPixel(x, y);
 			brightness = (pix.red * RED_PART + pix.green * GREEN_PART + pix.blue * BLUE_PART);
 			for (charID = 0; charID <= CHARSET_SIZE; charID++)
 			{
@@ -2,7 +2,7 @@
 // File       : Filter.cpp
 // Author     : riyufuchi
 // Created on : Feb 20, 2025
-// Last edit  : Nov 20, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -16,41 +16,24 @@ bool purplefier(consoleartlib::Image& image)
 {
 	if (!image)
 		return false;
-	const consoleartlib::ImageInfo& info = image.getImageInfo();
-	consoleartlib::Pixel pixel;
-	for (int y = 0; y < info.height; y++)
-	{
-		for (int x = 0; x < info.width; x++)
-		{
-			pixel = image.getPixel(x, y);
-			pixel.red = pixel.blue;
-			image.setPixel(x,y, pixel);
-		}
-	}
+	consoleartlib::image_tools::forEachPixel(image, [](consoleartlib::Pixel& pixel) { pixel.red = pixel.blue; });
 	return (image >> "-purplefied").saveImage();
 }
 bool purplefierSoft(consoleartlib::Image& image)
 {
 	if (!image)
 		return false;
-	const consoleartlib::ImageInfo& info = image.getImageInfo();
-	consoleartlib::Pixel pixel;
-	for (int y = 0; y < info.height; y++)
+	consoleartlib::image_tools::forEachPixel(image, [](consoleartlib::Pixel& pixel)
 	{
-		for (int x = 0; x < info.width; x++)
+		pixel.red = static_cast<uint16_t>(pixel.blue + pixel.red) / 2;
+		pixel.blue = pixel.red;
+		if (pixel.blue < pixel.green)
 		{
-			pixel = image.getPixel(x, y);
-			pixel.red = static_cast<uint16_t>(pixel.blue + pixel.red) / 2;
-			pixel.blue = pixel.red;
-			if (pixel.blue < pixel.green)
-			{
-				pixel.green = static_cast<uint16_t>(pixel.blue + pixel.red + pixel.green) / 3;
-				pixel.red = pixel.green;
-				pixel.blue = pixel.green;
-			}
-			image.setPixel(x,y, pixel);
+			pixel.green = static_cast<uint16_t>(pixel.blue + pixel.red + pixel.green) / 3;
+			pixel.red = pixel.green;
+			pixel.blue = pixel.green;
 		}
-	}
+	});
 	std::cout << "\n";
 	return (image >> "-purplefiedSoft").saveImage();
 }
@@ -58,45 +41,31 @@ bool purplefierShading(consoleartlib::Image& image)
 {
 	if (!image)
 		return false;
-	const consoleartlib::ImageInfo& info = image.getImageInfo();
-	consoleartlib::Pixel pixel;
-	for (int y = 0; y < info.height; y++)
+	consoleartlib::image_tools::forEachPixel(image, [](consoleartlib::Pixel& pixel)
 	{
-		for (int x = 0; x < info.width; x++)
-		{
-			pixel = image.getPixel(x, y);
-			pixel.red = pixel.blue;
-			if (pixel.red < pixel.green)
-				pixel.green = pixel.red;
-			image.setPixel(x,y, pixel);
-		}
-	}
+		pixel.red = pixel.blue;
+		if (pixel.red < pixel.green)
+			pixel.green = pixel.red;
+	});
 	return (image >> "-purplefiedShaded").saveImage();
 }
 bool purplefierShadingSoft(consoleartlib::Image& image)
 {
 	if (!image)
 		return false;
-	const consoleartlib::ImageInfo& info = image.getImageInfo();
-	consoleartlib::Pixel pixel;
-	for (int y = 0; y < info.height; y++)
+	consoleartlib::image_tools::forEachPixel(image, [](consoleartlib::Pixel& pixel)
 	{
-		for (int x = 0; x < info.width; x++)
+		if (pixel.blue < pixel.green)
 		{
-			pixel = image.getPixel(x, y);
-			if (pixel.blue < pixel.green)
-			{
-				pixel.green = static_cast<uint16_t>(pixel.blue + pixel.red + pixel.green) / 3;
-				pixel.red = pixel.green;
-				pixel.blue = pixel.green;
-			}
-			else
-			{
-				pixel.red = static_cast<uint16_t>(pixel.blue + pixel.red) / 2;
-			}
-			image.setPixel(x,y, pixel);
+			pixel.green = static_cast<uint16_t>(pixel.blue + pixel.red + pixel.green) / 3;
+			pixel.red = pixel.green;
+			pixel.blue = pixel.green;
 		}
-	}
+		else
+		{
+			pixel.red = static_cast<uint16_t>(pixel.blue + pixel.red) / 2;
+		}
+	});
 	std::cout << "\n";
 	return (image >> "-purplefiedShadedSoft").saveImage();
 }
@@ -104,21 +73,22 @@ bool matrixFilter(consoleartlib::Image& image)
 {
 	if (!image)
 		return false;
-	const consoleartlib::ImageInfo& info = image.getImageInfo();
 	const double RED_FRACTION = 7 / 5.0;
 	const double BLUE_FRACTION = 8 / 5.0;
 	const unsigned char MAX_COLOR = 255;
-	consoleartlib::Pixel pixel;
-	for (int y = 0; y < info.height; y++)
+	// Both curves depend only on the channel value, so they are tabulated once
+	uint8_t redCurve[256];
+	uint8_t blueCurve[256];
+	for (int value = 0; value < 256; value++)
 	{
-		for (int x = 0; x < info.width; x++)
-		{
-			pixel = image.getPixel(x, y);
-			pixel.red = std::pow((double)pixel.red / MAX_COLOR, RED_FRACTION) * MAX_COLOR;
-			pixel.blue = std::pow((double)pixel.blue / MAX_COLOR, BLUE_FRACTION) * MAX_COLOR;
-			image.setPixel(x,y, pixel);
-		}
+		redCurve[value] = std::pow((double)value / MAX_COLOR, RED_FRACTION) * MAX_COLOR;
+		blueCurve[value] = std::pow((double)value / MAX_COLOR, BLUE_FRACTION) * MAX_COLOR;
 	}
+	consoleartlib::image_tools::forEachPixel(image, [&](consoleartlib::Pixel& pixel)
+	{
+		pixel.red = redCurve[pixel.red];
+		pixel.blue = blueCurve[pixel.blue];
+	});
 	return (image >> "-matrix").saveImage();
 }
 }
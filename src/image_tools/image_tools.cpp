@@ -2,7 +2,7 @@
 // File       : ImageTools.cpp
 // Author     : riyufuchi
 // Created on : Dec 01, 2023
-// Last edit  : Nov 20, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) Riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -12,49 +12,25 @@
 namespace consoleartlib::image_tools
 {
 
+std::unique_ptr<unsigned char[]> interleaveView(const consoleartlib::ConstImageView& planarView)
+{
+	const int CHANNELS = planarView.getChannels();
+	std::unique_ptr<unsigned char[]> interleavedData = std::make_unique<unsigned char[]>(planarView.getWidth() * planarView.getHeight() * CHANNELS); // Supports RGB or RGBA
+	consoleartlib::ImageView target(interleavedData.get(), planarView.getWidth(), planarView.getHeight(), CHANNELS, CHANNELS, 1,
+			planarView.getWidth() * CHANNELS, planarView.getPixelByteOrder());
+	consoleartlib::copyPixels(planarView, target);
+	return interleavedData;
+}
 std::unique_ptr<unsigned char[]> convertPlanarPCXToInterleaved(const consoleartlib::ImagePCX::PagePCX& image)
 {
-	int totalPixels = image.image.width * image.image.height;
-
-	unsigned char* interleavedData = new unsigned char[totalPixels * image.header.numOfColorPlanes]; // Supports RGB or RGBA
-
-	int pixelIndex = 0;
-	int RGBpos = 0;
-	for (int y = 0; y < image.image.height; y++)
-	{
-		for (int x = 0; x < image.image.width; x++)
-		{
-			pixelIndex = (y * image.header.numOfColorPlanes * image.header.bytesPerLine) + x;
-			RGBpos = (y * image.image.width + x) * 3;
-			interleavedData[RGBpos] = image.pixelData[pixelIndex];
-			interleavedData[RGBpos + 1] = image.pixelData[image.header.bytesPerLine + pixelIndex];
-			interleavedData[RGBpos + 2] = image.pixelData[(image.header.bytesPerLine * 2) + pixelIndex];
-		}
-	}
-	return std::unique_ptr<unsigned char []>(interleavedData);
+	const consoleartlib::ImagePCX::HeaderPCX& header = image.header;
+	consoleartlib::ConstImageView planarView(image.pixelData.data(), image.image.width, image.image.height, header.numOfColorPlanes,
+			1, header.bytesPerLine, header.bytesPerLine * header.numOfColorPlanes);
+	return interleaveView(planarView);
 }
 std::unique_ptr<unsigned char[]> convertPlanarPCXToInterleaved(const consoleartlib::ImagePCX& image)
 {
-	const consoleartlib::ImagePCX::HeaderPCX &header = image.getHeader();
-	int totalPixels = image.getWidth() * image.getHeight();
-
-	std::unique_ptr planarData = image.getImageData();
-	unsigned char* interleavedData = new unsigned char[totalPixels * header.numOfColorPlanes]; // Supports RGB or RGBA
-
-	int pixelIndex = 0;
-	int RGBpos = 0;
-	for (int y = 0; y < image.getHeight(); y++)
-	{
-		for (int x = 0; x < image.getWidth(); x++)
-		{
-			pixelIndex = (y * header.numOfColorPlanes * header.bytesPerLine) + x;
-			RGBpos = (y * image.getWidth() + x) * 3;
-			interleavedData[RGBpos] = planarData[pixelIndex];
-			interleavedData[RGBpos + 1] = planarData[header.bytesPerLine + pixelIndex];
-			interleavedData[RGBpos + 2] = planarData[(header.bytesPerLine * 2) + pixelIndex];
-		}
-	}
-	return std::unique_ptr<unsigned char []>(interleavedData);
+	return interleaveView(image.getView());
 }
 unsigned char* normalizeToRGBA(const consoleartlib::Image& image, consoleartlib::ImageInfo& imageInfo)
 {
@@ -65,36 +41,26 @@ unsigned char* normalizeToRGBA(const consoleartlib::Image& image, consoleartlib:
 		imageInfo.bits = 24;
 	}
 	unsigned char* imageDat = new unsigned char[imageInfo.width * imageInfo.height * CHANNELS];
-	consoleartlib::Pixel pixel;
-	int xyCord = 0;
-	if (image.isInverted())
-		for(int y = 0; y < imageInfo.height; y++)
-		{
-			for (int x = 0; x < imageInfo.width; x++)
-			{
-				pixel = image.getPixel(x, y);
-				xyCord = ((imageInfo.height - 1 - y) * imageInfo.width + x) * CHANNELS; // Fix: Flip row position
-				imageDat[xyCord] = pixel.red;
-				imageDat[xyCord + 1] = pixel.green;
-				imageDat[xyCord + 2] = pixel.blue;
-				if (CHANNELS == 4)
-					imageDat[xyCord + 3] = pixel.alpha;
-			}
-		}
-	else
-		for(int y = 0; y < imageInfo.height; y++)
-		{
-			for (int x = 0; x < imageInfo.width; x++)
+	std::vector<consoleartlib::Pixel> row(imageInfo.width);
+	unsigned char* dst = nullptr;
+	for (int y = 0; y < imageInfo.height; y++)
+	{
+		image.readScanline(y, row);
+		if (image.isInverted())
+			dst = imageDat + (imageInfo.height - 1 - y) * imageInfo.width * CHANNELS; // Fix: Flip row position
+		else
+			dst = imageDat + y * imageInfo.width * CHANNELS;
+		if (CHANNELS == 4)
+			std::memcpy(dst, row.data(), row.size() * sizeof(consoleartlib::Pixel));
+		else
+			for (const consoleartlib::Pixel& pixel : row)
 			{
-				pixel = image.getPixel(x, y);
-				xyCord = (y * imageInfo.width + x) * CHANNELS;
-				imageDat[xyCord] = pixel.red;
-				imageDat[xyCord + 1] = pixel.green;
-				imageDat[xyCord + 2] = pixel.blue;
-				if (CHANNELS == 4)
-					imageDat[xyCord + 3] = pixel.alpha;
+				dst[0] = pixel.red;
+				dst[1] = pixel.green;
+				dst[2] = pixel.blue;
+				dst += 3;
 			}
-		}
+	}
 	return imageDat;
 }
 void addToImageName(consoleartlib::Image& image,const std::string addStr)
@@ -122,20 +88,35 @@ void nearestNeighbor(const consoleartlib::Image& originalImage, consoleartlib::I
 	const double scaleX = static_cast<double>(canvasInfo.width) / scaledInfo.width;
 	const double scaleY = static_cast<double>(canvasInfo.height) / scaledInfo.height;
 
-	int srcX = 0;
-	int srcY = 0;
+	// Source columns are the same for every row, so they are computed only once
+	std::vector<int> srcColumns(scaledInfo.width);
+	for (int x = 0; x < scaledInfo.width; x++)
+		srcColumns[x] = std::min(static_cast<int>(x * scaleX), canvasInfo.width - 1); // Clamp to prevent out-of-bounds access
 
-	for (int y = 0; y < scaledInfo.height; y++)
+	std::vector<consoleartlib::Pixel> dstRow(scaledInfo.width);
+	const consoleartlib::ConstImageView source = originalImage.getView();
+	// Picked pixels are decoded straight from the source layout, without converting whole source rows
+	source.dispatch([&](const auto format)
 	{
+		std::vector<ptrdiff_t> srcOffsets(scaledInfo.width);
 		for (int x = 0; x < scaledInfo.width; x++)
+			srcOffsets[x] = srcColumns[x] * format.step();
+		const uint8_t* srcRow = nullptr;
+		int srcY = 0;
+		int lastSrcY = -1;
+		for (int y = 0; y < scaledInfo.height; y++)
 		{
-			// Clamp to prevent out-of-bounds access
-			srcX = std::min(static_cast<int>(x * scaleX), canvasInfo.width - 1);
 			srcY = std::min(static_cast<int>(y * scaleY), canvasInfo.height - 1);
-
-			scaledImage.setPixel(x, y, originalImage.getPixel(srcX, srcY));
+			if (srcY != lastSrcY)
+			{
+				srcRow = source.row(srcY);
+				for (int x = 0; x < scaledInfo.width; x++)
+					dstRow[x] = format.load(srcRow + srcOffsets[x]);
+				lastSrcY = srcY;
+			}
+			scaledImage.writeScanline(y, dstRow);
 		}
-	}
+	});
 }
 
 bool signatureToImage(consoleartlib::Image& canvasImage, const consoleartlib::Image& signature)
@@ -164,60 +145,34 @@ bool signatureToImage(consoleartlib::Image& canvasImage, const consoleartlib::Im
 	const int X = canvasInfo.width - targetWidth;
 	const int Y = canvasInfo.height - targetHeight;
 
-	int x = 0;
-	int x1 = 0;
-
-	consoleartlib::Pixel pixel;
-	consoleartlib::Pixel pixelCanvas;
-	consoleartlib::Pixel pixelBlend;
+	std::vector<consoleartlib::Pixel> signatureRow(targetWidth);
+	std::vector<consoleartlib::Pixel> canvasRow(canvasInfo.width);
+	consoleartlib::Pixel* pixelCanvas = nullptr;
+	int canvasY = 0;
 
-	if (canvasImage.isInverted())
+	for (int y = 0; y < targetHeight; y++)
 	{
-		for (int y = 0, y1 = targetHeight; y1 >= 0; y++, y1--)
+		// Bottom-up images keep the bottom-right corner in their first rows
+		canvasY = canvasImage.isInverted() ? (targetHeight - 1 - y) : (Y + y);
+		resizedSignature.readScanline(y, signatureRow);
+		canvasImage.readScanline(canvasY, canvasRow);
+		pixelCanvas = canvasRow.data() + X;
+		for (const consoleartlib::Pixel& pixel : signatureRow)
 		{
-			for (x = X, x1 = 0; x < canvasInfo.width; x++, x1++)
+			switch (pixel.alpha)
 			{
-				pixel = resizedSignature.getPixel(x1, y1);
-				switch (pixel.alpha)
-				{
-					case 0: continue;
-					case 255: canvasImage.setPixel(x, y, pixel); break;
-					default:
-						pixelCanvas = canvasImage.getPixel(x, y);
-						pixelBlend.red = (pixel.red * pixel.alpha + pixelCanvas.red * (255 - pixel.alpha)) / 255;
-						pixelBlend.green = (pixel.green * pixel.alpha + pixelCanvas.green * (255 - pixel.alpha)) / 255;
-						pixelBlend.blue = (pixel.blue * pixel.alpha + pixelCanvas.blue * (255 - pixel.alpha)) / 255;
-						//pixelBlend.alpha = 255; // Result is fully opaquexel = resizedSignature.getPixel(x1, y1);
-						canvasImage.setPixel(x, y, pixelBlend);
-					break;
-				}
-			}
-		}
-	}
-	else
-	{
-		for (int y = Y, y1 = 0; y < canvasInfo.height; y++, y1++)
-		{
-			for (x = X, x1 = 0; x < canvasInfo.width; x++, x1++)
-			{
-				pixel = resizedSignature.getPixel(x1, y1);
-				switch (pixel.alpha)
-				{
-					case 0: continue;
-					case 255:
-						canvasImage.setPixel(x, y, pixel);
-					break;
-					default:
-						pixelCanvas = canvasImage.getPixel(x, y);
-						pixelBlend.red = (pixel.red * pixel.alpha + pixelCanvas.red * (255 - pixel.alpha)) / 255;
-						pixelBlend.green = (pixel.green * pixel.alpha + pixelCanvas.green * (255 - pixel.alpha)) / 255;
-						pixelBlend.blue = (pixel.blue * pixel.alpha + pixelCanvas.blue * (255 - pixel.alpha)) / 255;
-						//pixelBlend.alpha = 255; // Result is fully opaquexel = resizedSignature.getPixel(x1, y1);
-						canvasImage.setPixel(x, y, pixelBlend);
-					break;
-				}
+				case 0: break;
+				case 255: *pixelCanvas = pixel; break;
+				default:
+					pixelCanvas->red = (pixel.red * pixel.alpha + pixelCanvas->red * (255 - pixel.alpha)) / 255;
+					pixelCanvas->green = (pixel.green * pixel.alpha + pixelCanvas->green * (255 - pixel.alpha)) / 255;
+					pixelCanvas->blue = (pixel.blue * pixel.alpha + pixelCanvas->blue * (255 - pixel.alpha)) / 255;
+					pixelCanvas->alpha = 255; // Result is fully opaque
+				break;
 			}
+			pixelCanvas++;
 		}
+		canvasImage.writeScanline(canvasY, canvasRow);
 	}
 
 	canvasImage >> "-signed";
@@ -228,15 +183,7 @@ bool convertImage(const consoleartlib::Image& source, consoleartlib::Image& targ
 {
 	if (source != target)
 		return false;
-	int x;
-	for (int y = 0; y < source.getHeight(); y++)
-	{
-		for (x = 0; x < source.getWidth(); x++)
-		{
-			target.setPixel(x, y, source.getPixel(x, y));
-		}
-	}
-	return true;
+	return consoleartlib::copyPixels(source.getView(), target.getView());
 }
 
 } /* namespace ImageUtils */
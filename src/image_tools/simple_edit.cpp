@@ -2,7 +2,7 @@
 // File       : SimpleEdit.cpp
 // Author     : riyufuchi
 // Created on : Mar 21, 2025
-// Last edit  : Dec 20, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -21,17 +21,18 @@ bool overlayTextures(const consoleartlib::Image& bottomlayer, const consoleartli
 	if (bottomlayer > overlay)
 		return false;
 	consoleartlib::ImagePNG resultImage(bottomlayer.getFilename().substr(0, bottomlayer.getFilename().size() - 4) + "_" + overlay.getFilename(), bottomlayer.getWidth(), bottomlayer.getHeight(), bottomlayer.getBits()/8);
-	consoleartlib::Pixel pixel;
+	std::vector<consoleartlib::Pixel> row(bottomlayer.getWidth());
+	std::vector<consoleartlib::Pixel> overlayRow(bottomlayer.getWidth());
 	for(int y = 0; y < bottomlayer.getHeight(); y++)
 	{
-		for (int x = 0; x < bottomlayer.getWidth(); x++)
+		bottomlayer.readScanline(y, row);
+		overlay.readScanline(y, overlayRow);
+		for (size_t x = 0; x < row.size(); x++)
 		{
-			pixel = overlay.getPixel(x, y);
-			if (pixel.alpha > 0)
-				resultImage.setPixel(x, y, pixel);
-			else
-				resultImage.setPixel(x, y, bottomlayer.getPixel(x, y));
+			if (overlayRow[x].alpha > 0)
+				row[x] = overlayRow[x];
 		}
+		resultImage.writeScanline(y, row);
 	}
 	return resultImage.saveImage();
 }
@@ -47,16 +48,16 @@ bool removeGrayFromTexture(const std::string& originalPicturePath,  const std::s
 	if (!originalTexture)
 		return false;
 	consoleartlib::ImagePNG targetTexture(outputPicturePath, originalTexture.getWidth(), originalTexture.getHeight(), originalTexture.getBits() / 8);
-	consoleartlib::Pixel pixel;
+	std::vector<consoleartlib::Pixel> row(originalTexture.getWidth());
 	for(int y = 0; y < originalTexture.getHeight(); y++)
 	{
-		for (int x = 0; x < originalTexture.getWidth(); x++)
+		originalTexture.readScanline(y, row);
+		for (consoleartlib::Pixel& pixel : row)
 		{
-			pixel = originalTexture.getPixel(x, y);
 			if (isPixelGray(pixel.red, pixel.green, pixel.blue))
 				pixel.alpha = 0;
-			targetTexture.setPixel(x, y, pixel);
 		}
+		targetTexture.writeScanline(y, row);
 	}
 	return targetTexture.saveImage();
 }
@@ -65,19 +66,11 @@ bool removeGrayFromTexture(consoleartlib::Image& originalTexture)
 {
 	if (!originalTexture)
 		return false;
-	consoleartlib::Pixel pixel;
-	for(int y = 0; y < originalTexture.getHeight(); y++)
+	consoleartlib::image_tools::forEachPixel(originalTexture, [](consoleartlib::Pixel& pixel)
 	{
-		for (int x = 0; x < originalTexture.getWidth(); x++)
-		{
-			pixel = originalTexture.getPixel(x, y);
-			if (isPixelGray(pixel.red, pixel.green, pixel.blue))
-			{
-				pixel.alpha = 0;
-				originalTexture.setPixel(x, y, pixel);
-			}
-		}
-	}
+		if (isPixelGray(pixel.red, pixel.green, pixel.blue))
+			pixel.alpha = 0;
+	});
 	return originalTexture.saveImage();
 }
 
@@ -0,0 +1,179 @@
+//==============================================================================
+// File       : BandStream.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Reading and writing images a band of rows at a time
+//==============================================================================
+
+#include "../../consoleartlib/images/base/band_stream.h"
+
+namespace consoleartlib
+{
+//
+// BandReader
+//
+BandReader::BandReader(const std::string& filepath, int bandHeight, const LoadOptions& options) : stream(filepath, options.source),
+	band(options.memoryResource ? options.memoryResource : std::pmr::get_default_resource()), bandHeight(std::max(bandHeight, 1)), nextRow(0)
+{
+	size_t xPos;
+	info.name = ((xPos = filepath.find_last_of('/')) != std::string::npos) ? filepath.substr(xPos + 1) : filepath;
+	if (!stream)
+		technical.technicalMessage = "Unable to open file: " + filepath;
+}
+BandReader::~BandReader()
+{
+}
+ImageView BandReader::readBand()
+{
+	if (!isValid() || isFinished())
+		return ImageView();
+	const int COUNT = std::min(bandHeight, info.height - nextRow);
+	// Band buffer is sized once, for the tallest band
+	if (band.empty())
+		band.resize(format.rowStride * static_cast<size_t>(std::min(bandHeight, info.height)));
+	if (!decodeRows(band.data(), COUNT))
+	{
+		technical.fileState = FileState::INVALID_IMAGE_FILE;
+		return ImageView();
+	}
+	nextRow += COUNT;
+	return ImageView(band.data(), info.width, COUNT, format);
+}
+bool BandReader::isValid() const
+{
+	return technical.fileState == FileState::VALID_IMAGE_FILE;
+}
+bool BandReader::isFinished() const
+{
+	return nextRow >= info.height;
+}
+int BandReader::getNextRow() const
+{
+	return nextRow;
+}
+int BandReader::getBandHeight() const
+{
+	return bandHeight;
+}
+const ImageInfo& BandReader::getImageInfo() const
+{
+	return info;
+}
+const std::string& BandReader::getFileStatus() const
+{
+	return technical.technicalMessage;
+}
+const ScanlineFormat& BandReader::getScanlineFormat() const
+{
+	return format;
+}
+//
+// BandWriter
+//
+BandWriter::BandWriter(const std::string& filepath, int width, int height, std::ostream* target) : out(nullptr), rowsWritten(0)
+{
+	if (target)
+		out.rdbuf(target->rdbuf());
+	else if (file.open(filepath, std::ios::out | std::ios::binary | std::ios::trunc))
+		out.rdbuf(&file);
+	size_t xPos;
+	info.name = ((xPos = filepath.find_last_of('/')) != std::string::npos) ? filepath.substr(xPos + 1) : filepath;
+	info.width = width;
+	info.height = height;
+	if (!out.rdbuf())
+	{
+		technical.technicalMessage = "Unable to create file: " + filepath;
+	}
+	else if (width <= 0 || height <= 0)
+	{
+		technical.technicalMessage = "Invalid image size";
+	}
+	else
+	{
+		technical.technicalMessage = "Ready for image data";
+		technical.fileState = FileState::VALID_IMAGE_FILE;
+	}
+}
+BandWriter::~BandWriter()
+{
+}
+bool BandWriter::finishFile()
+{
+	return true;
+}
+bool BandWriter::writeBand(const ConstImageView& rows)
+{
+	if (!isValid() || !rows)
+		return false;
+	if (rows.getWidth() != info.width || rows.getHeight() > info.height - rowsWritten)
+	{
+		technical.technicalMessage = "Band doesn't fit the image";
+		technical.fileState = FileState::INVALID_IMAGE_FILE;
+		return false;
+	}
+	bool encoded;
+	const bool SAME_LAYOUT = rows.getChannels() == format.channels && rows.getChannelStride() == static_cast<ptrdiff_t>(format.channelStride) &&
+		rows.getPixelStride() == static_cast<ptrdiff_t>(format.pixelStride) && rows.getRowStride() == static_cast<ptrdiff_t>(format.rowStride) &&
+		(rows.getPixelByteOrder() == format.pixelByteOrder || format.channels < 3);
+	if (SAME_LAYOUT)
+	{
+		encoded = encodeRows(rows.data(), rows.getHeight());
+	}
+	else
+	{
+		// Zeroed once, so padding bytes of the file layout stay clean
+		const size_t SIZE = format.rowStride * static_cast<size_t>(rows.getHeight());
+		if (band.size() < SIZE)
+			band.resize(SIZE, 0);
+		copyPixels(rows, ImageView(band.data(), info.width, rows.getHeight(), format));
+		encoded = encodeRows(band.data(), rows.getHeight());
+	}
+	if (!encoded || !out)
+	{
+		technical.technicalMessage = "Writing of image data failed";
+		technical.fileState = FileState::INVALID_IMAGE_FILE;
+		return false;
+	}
+	rowsWritten += rows.getHeight();
+	return true;
+}
+bool BandWriter::finish()
+{
+	if (!isValid())
+		return false;
+	if (rowsWritten != info.height)
+	{
+		technical.technicalMessage = "Only " + std::to_string(rowsWritten) + " of " + std::to_string(info.height) + " rows were written";
+		technical.fileState = FileState::INVALID_IMAGE_FILE;
+		return false;
+	}
+	if (!finishFile() || !out.flush())
+	{
+		technical.technicalMessage = "Writing of image data failed";
+		technical.fileState = FileState::INVALID_IMAGE_FILE;
+		return false;
+	}
+	if (file.is_open())
+		file.close();
+	technical.technicalMessage = "Image written";
+	return true;
+}
+bool BandWriter::isValid() const
+{
+	return technical.fileState == FileState::VALID_IMAGE_FILE;
+}
+int BandWriter::getRowsWritten() const
+{
+	return rowsWritten;
+}
+const ImageInfo& BandWriter::getImageInfo() const
+{
+	return info;
+}
+const std::string& BandWriter::getFileStatus() const
+{
+	return technical.technicalMessage;
+}
+} /* namespace consoleartlib */
@@ -2,7 +2,7 @@
 // File       : Image.cpp
 // Author     : Riyufuchi
 // Created on : Nov 20, 2023
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) Riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -11,7 +11,8 @@
 
 namespace consoleartlib
 {
-Image::Image(const std::string& filepath, ImageType format) : filepath(filepath)
+Image::Image(const std::string& filepath, ImageType format, const LoadOptions& options) : filepath(filepath), options(options),
+	pixelData(selectResource(options))
 {
 	size_t xPos;
 	if ((xPos = filepath.find_last_of('/')) != std::string::npos)
@@ -19,10 +20,45 @@ Image::Image(const std::string& filepath, ImageType format) : filepath(filepath)
 	else
 		this->image.name = filepath;
 	image.imageFormat = format;
+	this->options.downscale = static_cast<int>(std::bit_floor(static_cast<unsigned>(std::clamp(options.downscale, 1, 8))));
+}
+// Short enough for the small string buffer, so invalidating moved image doesn't allocate
+static constexpr std::string_view MOVED_MESSAGE = "Image was moved";
+
+Image::Image(Image&& other) noexcept : filepath(std::move(other.filepath)), image(std::move(other.image)), technical(std::move(other.technical)),
+	options(other.options), pixelData(std::move(other.pixelData)), decodePending(other.decodePending)
+{
+	other.invalidate(MOVED_MESSAGE);
+}
+Image& Image::operator=(Image&& other) noexcept
+{
+	if (this != &other)
+	{
+		filepath = std::move(other.filepath);
+		image = std::move(other.image);
+		technical = std::move(other.technical);
+		options = other.options;
+		// Polymorphic allocator doesn't propagate on move assignment, buffer from other resource would be copied,
+		// rebuilding the vector takes over the allocator with the buffer, as options.memoryResource now says
+		std::destroy_at(&pixelData);
+		std::construct_at(&pixelData, std::move(other.pixelData));
+		decodePending = other.decodePending;
+		other.invalidate(MOVED_MESSAGE);
+	}
+	return *this;
 }
 Image::~Image()
 {
 }
+void Image::invalidate(std::string_view reason)
+{
+	pixelData.clear();
+	decodePending = false;
+	image.width = 0;
+	image.height = 0;
+	technical.fileState = FileState::INVALID_IMAGE_FILE;
+	technical.technicalMessage = reason;
+}
 std::ostream& operator<<(std::ostream& os, const Image& img)
 {
 	return os << std::boolalpha << "Name: " << img.image.name << "\n"
@@ -36,6 +72,92 @@ std::ostream& operator<<(std::ostream& os, const Image& img)
 			<< "Multi-page: " << img.image.multipage << "\n"
 			<< "HDR: " << img.image.hdr << "\n" << std::noboolalpha;
 }
+/**
+ * Finishes constructor of deferred image with result of header probe.
+ */
+void Image::deferDecode(const TechnicalInfo& probeResult)
+{
+	technical = probeResult;
+	decodePending = technical.fileState == FileState::VALID_IMAGE_FILE;
+	if (decodePending)
+	{
+		// Deferred image already reports the size it will have after decoding
+		const ImageRegion REGION = clipRegion(options.region, image.width, image.height);
+		image.width = reducedSize(REGION.width, options.downscale);
+		image.height = reducedSize(REGION.height, options.downscale);
+	}
+}
+void Image::decodeNow()
+{
+	decodePending = false;
+	technical.fileState = FileState::INVALID_IMAGE_FILE;
+	loadImage();
+}
+/**
+ * @return Requested region clipped to the image, whole image when no region was requested.
+ * Empty when the requested region lies outside of the image.
+ */
+ImageRegion Image::clipRegion(const ImageRegion& requested, int fullWidth, int fullHeight)
+{
+	if (requested.isEmpty())
+		return {0, 0, fullWidth, fullHeight};
+	ImageRegion region;
+	region.x = std::clamp(requested.x, 0, fullWidth);
+	region.y = std::clamp(requested.y, 0, fullHeight);
+	region.width = std::clamp(requested.x + requested.width, 0, fullWidth) - region.x;
+	region.height = std::clamp(requested.y + requested.height, 0, fullHeight) - region.y;
+	return region;
+}
+/**
+ * Fills pixel data from tightly packed rows (as decoders like stb return them), adding row padding.
+ */
+void Image::importRows(const uint8_t* packedRows)
+{
+	importRegion(packedRows, image.width, {0, 0, image.width, image.height});
+}
+/**
+ * Like importRows(), but takes only a region of bigger packed image, reduced by options.downscale.
+ * Image width and height must already be set to the final size.
+ */
+void Image::importRegion(const uint8_t* packedRows, int fullWidth, const ImageRegion& region)
+{
+	const size_t ROW_SIZE = static_cast<size_t>(image.width) * image.channels;
+	const size_t FULL_ROW_SIZE = static_cast<size_t>(fullWidth) * image.channels;
+	const size_t STRIDE = getRowStride();
+	const uint8_t* first = packedRows + region.y * FULL_ROW_SIZE + region.x * image.channels;
+	pixelData.resize(STRIDE * image.height);
+	if (options.downscale > 1)
+	{
+		BoxFilter<uint8_t>(region.width, image.channels, options.downscale).reduce(first, region.height, FULL_ROW_SIZE, pixelData.data(), STRIDE);
+		for (int y = 0; y < image.height && STRIDE > ROW_SIZE; y++)
+			std::memset(pixelData.data() + y * STRIDE + ROW_SIZE, 0, STRIDE - ROW_SIZE);
+		return;
+	}
+	if (STRIDE == ROW_SIZE && ROW_SIZE == FULL_ROW_SIZE)
+	{
+		std::memcpy(pixelData.data(), first, pixelData.size());
+		return;
+	}
+	for (int y = 0; y < image.height; y++)
+	{
+		std::memcpy(pixelData.data() + y * STRIDE, first + y * FULL_ROW_SIZE, ROW_SIZE);
+		std::memset(pixelData.data() + y * STRIDE + ROW_SIZE, 0, STRIDE - ROW_SIZE);
+	}
+}
+/**
+ * @return Pixel data without row padding, either the buffer itself or the scratch filled with a packed copy
+ */
+const uint8_t* Image::exportRows(PixelBuffer& scratch) const
+{
+	const size_t ROW_SIZE = static_cast<size_t>(image.width) * image.channels;
+	const size_t STRIDE = getRowStride();
+	if (STRIDE == ROW_SIZE)
+		return pixelData.data();
+	scratch.resize(ROW_SIZE * image.height);
+	for (int y = 0; y < image.height; y++)
+		std::memcpy(scratch.data() + y * ROW_SIZE, pixelData.data() + y * STRIDE, ROW_SIZE);
+	return scratch.data();
+}
 void Image::rename(std::string imageName)
 {
 	imageName = imageName.append(image.name.substr(image.name.find('.')));
@@ -58,6 +180,93 @@ const std::string& Image::getFilepath() const
 {
 	return filepath;
 }
+/**
+ * Takes over pixel buffer of another image, leaving the source empty and invalid.
+ * When the target format stores pixels the same way as the source (for example PNG -> TGA or JPG)
+ * no pixel is touched, otherwise channels, planes and row order are rearranged inside the adopted buffer.
+ * The buffer moves only between images using the same memory resource, otherwise it is copied into this image's resource.
+ * @return false when this format can't hold the source image (the source is left untouched)
+ */
+bool Image::adoptPixelData(Image&& source)
+{
+	if (this == &source || !source)
+		return false;
+	source.ensureDecoded();
+	if (source.pixelData.empty())
+		return false;
+	ImageInfo layout = source.image;
+	layout.name = image.name;
+	layout.imageFormat = image.imageFormat;
+	layout.palette = false;
+	layout.animated = false;
+	layout.multipage = false;
+	if (!acceptLayout(layout))
+		return false;
+	const ScanlineFormat from = source.getScanlineFormat();
+	const bool fromInverted = source.image.inverted;
+	PixelBuffer data = std::move(source.pixelData);
+	source.invalidate("Pixel data were moved to " + image.name);
+	image = layout;
+	decodePending = false;
+	relayoutPixelData(data, image.width, image.height, from, fromInverted, getScanlineFormat(), image.inverted);
+	pixelData = std::move(data);
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	technical.technicalMessage = "Pixel data adopted";
+	return true;
+}
+/**
+ * Decides how this format stores adopted pixels. Formats override it to force their own
+ * channel count, byte order or orientation and to rebuild their headers for the new size.
+ * Default storage is interleaved top-down RGB or RGBA.
+ */
+bool Image::acceptLayout(ImageInfo& layout)
+{
+	layout.channels = (layout.channels == 4 || layout.channels == 2) ? 4 : 3;
+	layout.bits = layout.channels * 8;
+	layout.pixelByteOrder = PixelByteOrder::RGBA;
+	layout.planar = false;
+	layout.inverted = false;
+	return true;
+}
+void Image::markModified()
+{
+}
+/**
+ * Converts pixel data between two layouts inside the same buffer using only one scanline of scratch memory.
+ * Rows shrink front to back and grow back to front, so unread rows are never overwritten.
+ */
+void Image::relayoutPixelData(PixelBuffer& data, int width, int height, const ScanlineFormat& from, bool fromInverted,
+		const ScanlineFormat& to, bool toInverted)
+{
+	const bool SAME_LAYOUT = from.channels == to.channels && from.pixelStride == to.pixelStride && from.channelStride == to.channelStride &&
+			from.rowStride == to.rowStride && (from.pixelByteOrder == to.pixelByteOrder || from.channels < 3);
+	if (!SAME_LAYOUT)
+	{
+		PixelBuffer scratch(from.rowStride, data.get_allocator());
+		auto convertRow = [&](int y)
+		{
+			std::memcpy(scratch.data(), data.data() + y * from.rowStride, from.rowStride);
+			copyPixels(ConstImageView(scratch.data(), width, 1, from), ImageView(data.data() + y * to.rowStride, width, 1, to));
+		};
+		if (to.rowStride <= from.rowStride)
+		{
+			for (int y = 0; y < height; y++)
+				convertRow(y);
+			data.resize(to.rowStride * height);
+		}
+		else
+		{
+			data.resize(to.rowStride * height);
+			for (int y = height - 1; y >= 0; y--)
+				convertRow(y);
+		}
+	}
+	if (fromInverted != toInverted)
+	{
+		for (int y = 0; y < height / 2; y++)
+			std::swap_ranges(data.begin() + y * to.rowStride, data.begin() + (y + 1) * to.rowStride, data.begin() + (height - 1 - y) * to.rowStride);
+	}
+}
 bool Image::containsPalette() const
 {
 	return image.palette;
@@ -66,6 +275,10 @@ bool Image::isLoaded() const
 {
 	return technical.fileState == FileState::VALID_IMAGE_FILE;
 }
+bool Image::isDecodePending() const
+{
+	return decodePending;
+}
 bool Image::isInverted() const
 {
 	return image.inverted;
@@ -86,10 +299,33 @@ PixelByteOrder Image::getPixelFormat() const
 {
 	return image.pixelByteOrder;
 }
+/**
+ * Buffer allocator can't be replaced after construction, so the alignment adaptor is chosen up front.
+ */
+std::pmr::memory_resource* Image::selectResource(const LoadOptions& options)
+{
+	std::pmr::memory_resource* resource = options.memoryResource ? options.memoryResource : std::pmr::get_default_resource();
+	if (options.rowAlignment > 1)
+		return AlignedResource::of(resource, options.rowAlignment);
+	return resource;
+}
+std::pmr::memory_resource* Image::getMemoryResource() const
+{
+	return pixelData.get_allocator().resource();
+}
 std::unique_ptr<unsigned char[]> Image::getImageData() const
 {
+	ensureDecoded();
 	if (!image.inverted)
 	{
+		const size_t ROW_SIZE = static_cast<size_t>(image.width) * image.channels;
+		if (!getScanlineFormat().isPlanar() && getRowStride() != ROW_SIZE)
+		{
+			// Row padding is not part of the returned data, rows are packed straight into the copy
+			std::unique_ptr<unsigned char[]> dataCopy = std::make_unique<unsigned char[]>(ROW_SIZE * image.height);
+			copyPixels(getView(), ImageView(dataCopy.get(), image.width, image.height, image.channels, image.channels, 1, ROW_SIZE, image.pixelByteOrder));
+			return dataCopy;
+		}
 		std::unique_ptr<unsigned char[]> dataCopy = std::make_unique<unsigned char[]>(pixelData.size());
 		std::memcpy(dataCopy.get(), pixelData.data(), pixelData.size());
 		return dataCopy; // Returning a copy of pixelData, since caller will own it
@@ -97,17 +333,63 @@ std::unique_ptr<unsigned char[]> Image::getImageData() const
 
 	int cp = (image.channels <= 3) ? 3 : 4;
 	std::unique_ptr<unsigned char[]> flippedData = std::make_unique<unsigned char[]>(image.width * image.height * cp);
-
-	int rowSize = image.width * cp;
-	int srcRow = 0, dstRow = 0;
-	for (int y = 0; y < image.height; y++)
-	{
-		srcRow = (image.height - 1 - y) * rowSize;
-		dstRow = y * rowSize;
-		std::memcpy(&flippedData[dstRow], &pixelData[srcRow], rowSize);
-	}
-
+	ImageView target(flippedData.get(), image.width, image.height, cp, cp, 1, image.width * cp, image.pixelByteOrder);
+	copyPixels(getUprightView(), target);
 	return flippedData;
 }
+ScanlineFormat Image::getScanlineFormat() const
+{
+	ScanlineFormat format;
+	format.channels = image.channels;
+	format.pixelByteOrder = image.pixelByteOrder;
+	format.pixelStride = image.channels;
+	format.channelStride = 1;
+	format.rowStride = getRowStride();
+	return format;
+}
+std::span<uint8_t> Image::getScanline(int y)
+{
+	ensureDecoded();
+	markModified();
+	const size_t rowStride = getScanlineFormat().rowStride;
+	return std::span<uint8_t>(pixelData.data() + y * rowStride, rowStride);
+}
+std::span<const uint8_t> Image::getScanline(int y) const
+{
+	ensureDecoded();
+	const size_t rowStride = getScanlineFormat().rowStride;
+	return std::span<const uint8_t>(pixelData.data() + y * rowStride, rowStride);
+}
+/**
+ * Converts one scanline into pixels. The format is resolved once per row,
+ * so the inner loops are free of virtual calls and channel checks.
+ */
+void Image::readScanline(int y, std::span<Pixel> row) const
+{
+	getView().readRow(y, row);
+}
+void Image::writeScanline(int y, std::span<const Pixel> row)
+{
+	getView().writeRow(y, row);
+}
+ImageView Image::getView()
+{
+	ensureDecoded();
+	markModified();
+	return ImageView(pixelData.data(), image.width, image.height, getScanlineFormat());
+}
+ConstImageView Image::getView() const
+{
+	ensureDecoded();
+	return ConstImageView(pixelData.data(), image.width, image.height, getScanlineFormat());
+}
+ImageView Image::getUprightView()
+{
+	return image.inverted ? getView().flipVertical() : getView();
+}
+ConstImageView Image::getUprightView() const
+{
+	return image.inverted ? getView().flipVertical() : getView();
+}
 
 } /* namespace consoleartlib */
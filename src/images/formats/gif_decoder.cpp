@@ -0,0 +1,430 @@
+//==============================================================================
+// File       : GIFDecoder.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Decoding GIF animation one frame at a time
+//==============================================================================
+
+#include "../../consoleartlib/images/formats/gif_decoder.h"
+#include "../../consoleartlib/images/utils/parallel.hpp"
+
+namespace consoleartlib
+{
+GIFDecoder::GIFDecoder(const std::string& filepath, std::span<const uint8_t> source, unsigned threads) : stream(filepath, source), width(0), height(0),
+	threads(threads), firstBlock(0), frameIndex(-1), finished(false)
+{
+	if (!stream)
+	{
+		technical.technicalMessage = "Unable to open file: " + filepath;
+		return;
+	}
+	uint8_t header[13];
+	stream.read(reinterpret_cast<char*>(header), sizeof(header));
+	if (!stream || std::memcmp(header, "GIF8", 4) != 0)
+	{
+		technical.technicalMessage = "Not a GIF file";
+		return;
+	}
+	width = header[6] | (header[7] << 8);
+	height = header[8] | (header[9] << 8);
+	if (width == 0 || height == 0)
+	{
+		technical.technicalMessage = "Invalid image size";
+		return;
+	}
+	if (header[10] & 0x80)
+	{
+		std::vector<PixelRGB> colors(1 << ((header[10] & 0x07) + 1));
+		stream.read(reinterpret_cast<char*>(colors.data()), colors.size() * sizeof(PixelRGB));
+		if (!stream)
+		{
+			technical.technicalMessage = "Incomplete global color table";
+			return;
+		}
+		globalPalette = PaletteLUT(colors);
+	}
+	firstBlock = stream.tellg();
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+}
+void GIFDecoder::skipSubBlocks(std::istream& stream)
+{
+	int size = 0;
+	while ((size = stream.get()) > 0)
+		stream.seekg(size, std::ios::cur);
+}
+/**
+ * Reads blocks up to the next image, graphic control extension before it fills delay, disposal and transparency.
+ * @param compressed Receives compressed data, they are skipped when nullptr
+ */
+bool GIFDecoder::readFrame(GIFFrame& next, PaletteLUT& palette, int& minCodeSize, PixelBuffer* compressed)
+{
+	next = GIFFrame();
+	next.position = stream.tellg();
+	int block = 0;
+	while ((block = stream.get()) != EOF && block != 0x3B)
+	{
+		if (block == 0x21) // Extension
+		{
+			if (stream.get() != 0xF9)
+			{
+				skipSubBlocks(stream);
+				continue;
+			}
+			uint8_t control[4] = {0, 0, 0, 0};
+			const int SIZE = stream.get();
+			if (SIZE > 0)
+			{
+				stream.read(reinterpret_cast<char*>(control), std::min(SIZE, 4));
+				stream.seekg(std::max(SIZE - 4, 0), std::ios::cur);
+				skipSubBlocks(stream);
+			}
+			next.disposal = (control[0] >> 2) & 0x07;
+			next.delay = (control[1] | (control[2] << 8)) * 10;
+			next.transparentIndex = (control[0] & 0x01) ? control[3] : -1;
+		}
+		else if (block == 0x2C) // Image descriptor
+		{
+			uint8_t descriptor[9];
+			stream.read(reinterpret_cast<char*>(descriptor), sizeof(descriptor));
+			next.x = descriptor[0] | (descriptor[1] << 8);
+			next.y = descriptor[2] | (descriptor[3] << 8);
+			next.width = descriptor[4] | (descriptor[5] << 8);
+			next.height = descriptor[6] | (descriptor[7] << 8);
+			next.interlaced = descriptor[8] & 0x40;
+			palette = globalPalette;
+			if (descriptor[8] & 0x80)
+			{
+				std::vector<PixelRGB> colors(1 << ((descriptor[8] & 0x07) + 1));
+				stream.read(reinterpret_cast<char*>(colors.data()), colors.size() * sizeof(PixelRGB));
+				palette = PaletteLUT(colors);
+			}
+			minCodeSize = stream.get();
+			// Sub-blocks of one frame are joined, so LZW runs over one contiguous buffer
+			int size = 0;
+			if (!compressed)
+				skipSubBlocks(stream);
+			else
+				compressed->clear();
+			while (compressed && (size = stream.get()) > 0)
+			{
+				const size_t END = compressed->size();
+				compressed->resize(END + size);
+				stream.read(reinterpret_cast<char*>(compressed->data() + END), size);
+				if (!stream)
+				{
+					compressed->resize(END + stream.gcount());
+					break;
+				}
+			}
+			if (!stream)
+				finished = true; // Truncated frame is drawn as far as it goes and ends the animation
+			return true;
+		}
+		else
+		{
+			break; // Corrupted stream, frames read so far stay
+		}
+	}
+	finished = true;
+	return false;
+}
+void GIFDecoder::disposeFrame()
+{
+	if (frameIndex < 0 || (frame.disposal != 2 && frame.disposal != 3))
+		return;
+	const int X0 = std::clamp(frame.x, 0, width);
+	const int X1 = std::clamp(frame.x + frame.width, 0, width);
+	const int Y0 = std::clamp(frame.y, 0, height);
+	const int Y1 = std::clamp(frame.y + frame.height, 0, height);
+	const size_t ROW_SIZE = static_cast<size_t>(X1 - X0) * 4;
+	for (int y = Y0; y < Y1; y++)
+	{
+		uint8_t* row = canvas.data() + (static_cast<size_t>(y) * width + X0) * 4;
+		if (frame.disposal == 2)
+			std::memset(row, 0, ROW_SIZE);
+		else
+			std::memcpy(row, saved.data() + (y - Y0) * ROW_SIZE, ROW_SIZE);
+	}
+}
+/**
+ * @return Row of the frame stored as row-th in interlaced data
+ */
+static int interlacedRow(int row, int height)
+{
+	const int PASS1 = (height + 7) / 8;
+	if (row < PASS1)
+		return row * 8;
+	row -= PASS1;
+	const int PASS2 = (height + 3) / 8;
+	if (row < PASS2)
+		return 4 + row * 8;
+	row -= PASS2;
+	const int PASS3 = (height + 1) / 4;
+	if (row < PASS3)
+		return 2 + row * 4;
+	return 1 + (row - PASS3) * 2;
+}
+/**
+ * Composes decoded indexes over the canvas, transparent pixels keep what is under them.
+ */
+void GIFDecoder::drawFrame(const PaletteLUT& palette, const uint8_t* indexes, size_t decoded)
+{
+	const int X0 = std::clamp(frame.x, 0, width);
+	const int X1 = std::clamp(frame.x + frame.width, 0, width);
+	if (X1 <= X0 || frame.width == 0)
+		return;
+	const int ROWS = static_cast<int>((decoded + frame.width - 1) / frame.width);
+	for (int row = 0; row < ROWS; row++)
+	{
+		const int Y = frame.y + (frame.interlaced ? interlacedRow(row, frame.height) : row);
+		if (Y < 0 || Y >= height)
+			continue;
+		const size_t ROW_START = static_cast<size_t>(row) * frame.width;
+		const int END = static_cast<int>(std::min<size_t>(X1, frame.x + (decoded - ROW_START)));
+		if (END <= X0)
+			continue;
+		const uint8_t* source = indexes + ROW_START + (X0 - frame.x);
+		uint8_t* target = canvas.data() + (static_cast<size_t>(Y) * width + X0) * 4;
+		if (frame.transparentIndex < 0)
+		{
+			palette.expandInterleaved(source, END - X0, target, 4);
+			continue;
+		}
+		for (int x = 0; x < END - X0; x++)
+		{
+			if (source[x] == frame.transparentIndex)
+				continue;
+			const Pixel COLOR = palette[source[x]];
+			target[x * 4] = COLOR.red;
+			target[x * 4 + 1] = COLOR.green;
+			target[x * 4 + 2] = COLOR.blue;
+			target[x * 4 + 3] = COLOR.alpha;
+		}
+	}
+}
+/**
+ * Upper bound of indexes LZW data can produce. Every code takes at least minCodeSize + 1 bits
+ * and its string is at most one index longer than strings of codes before it, never longer than 4096.
+ */
+static size_t maxDecodedCount(size_t compressedSize, int minCodeSize)
+{
+	const size_t CODES = compressedSize * 8 / (std::max(minCodeSize, 1) + 1);
+	return (CODES < 8192) ? CODES * (CODES + 1) / 2 : CODES * 4096;
+}
+bool GIFDecoder::nextFrame()
+{
+	return nextFrames(1) == 1;
+}
+size_t GIFDecoder::nextFrames(size_t count, const std::function<void(const GIFDecoder&)>& composed)
+{
+	// Two frames per worker keep workers busy when frames differ in size, while memory stays bounded by the batch
+	const unsigned WORKERS = workerCount(threads, count);
+	const size_t BATCH_SIZE = (WORKERS > 1) ? 2 * WORKERS : 1;
+	size_t done = 0;
+	// Canvas is allocated with the first frame, so decoders made only to scan frames stay small
+	if (canvas.empty() && isValid())
+		canvas.assign(static_cast<size_t>(width) * height * 4, 0);
+	while (done < count && isValid() && !finished)
+	{
+		if (batch.size() < BATCH_SIZE)
+			batch.resize(BATCH_SIZE);
+		// Reading stays sequential, the file is one stream
+		size_t read = 0;
+		const size_t WANTED = std::min(BATCH_SIZE, count - done);
+		while (read < WANTED && !finished)
+		{
+			PendingFrame& pending = batch[read];
+			if (!readFrame(pending.frame, pending.palette, pending.minCodeSize, &pending.compressed))
+				break;
+			read++;
+		}
+		parallelFor(read, [this](size_t i)
+		{
+			PendingFrame& pending = batch[i];
+			// Descriptor alone could ask for gigabytes, indexes are allocated only for what the data can hold
+			const size_t COUNT = std::min(static_cast<size_t>(pending.frame.width) * pending.frame.height,
+					maxDecodedCount(pending.compressed.size(), pending.minCodeSize));
+			pending.indexes.resize(COUNT);
+			pending.decoded = decodeLZW(pending.compressed, pending.minCodeSize, pending.indexes.data(), COUNT);
+		}, threads);
+		for (size_t i = 0; i < read; i++)
+		{
+			const PendingFrame& pending = batch[i];
+			disposeFrame();
+			frame = pending.frame;
+			if (frame.disposal == 3)
+			{
+				const int X0 = std::clamp(frame.x, 0, width);
+				const int X1 = std::clamp(frame.x + frame.width, 0, width);
+				const int Y0 = std::clamp(frame.y, 0, height);
+				const int Y1 = std::clamp(frame.y + frame.height, 0, height);
+				const size_t ROW_SIZE = static_cast<size_t>(X1 - X0) * 4;
+				saved.resize(ROW_SIZE * (Y1 - Y0));
+				for (int y = Y0; y < Y1; y++)
+					std::memcpy(saved.data() + (y - Y0) * ROW_SIZE, canvas.data() + (static_cast<size_t>(y) * width + X0) * 4, ROW_SIZE);
+			}
+			drawFrame(pending.palette, pending.indexes.data(), pending.decoded);
+			frameIndex++;
+			done++;
+			if (composed)
+				composed(*this);
+		}
+		if (read < WANTED)
+			break;
+	}
+	return done;
+}
+bool GIFDecoder::seekFrame(int index)
+{
+	if (!isValid() || index < 0)
+		return false;
+	if (index < frameIndex)
+		rewind();
+	const size_t MISSING = index - frameIndex;
+	return nextFrames(MISSING) == MISSING;
+}
+void GIFDecoder::rewind()
+{
+	stream.clear();
+	stream.seekg(firstBlock);
+	std::fill(canvas.begin(), canvas.end(), 0);
+	frame = GIFFrame();
+	frameIndex = -1;
+	finished = false;
+}
+std::vector<GIFFrame> GIFDecoder::scanFrames()
+{
+	std::vector<GIFFrame> frames;
+	if (!isValid())
+		return frames;
+	const bool WAS_FINISHED = finished;
+	stream.clear();
+	const std::streampos POSITION = stream.tellg();
+	stream.seekg(firstBlock);
+	GIFFrame next;
+	PaletteLUT palette;
+	int minCodeSize = 0;
+	finished = false;
+	while (!finished && readFrame(next, palette, minCodeSize, nullptr))
+		frames.push_back(next);
+	stream.clear();
+	stream.seekg(POSITION);
+	finished = WAS_FINISHED;
+	return frames;
+}
+/**
+ * Variable length codes grow from minCodeSize + 1 up to 12 bits, strings are written back to front
+ * straight into indexes by following prefixes, so no stack is needed.
+ */
+size_t GIFDecoder::decodeLZW(std::span<const uint8_t> data, int minCodeSize, uint8_t* indexes, size_t count)
+{
+	if (minCodeSize < 1 || minCodeSize > 11)
+		return 0;
+	constexpr int MAX_CODES = 4096;
+	uint16_t prefix[MAX_CODES];
+	uint8_t suffix[MAX_CODES];
+	uint8_t first[MAX_CODES];
+	uint16_t length[MAX_CODES];
+	const int CLEAR = 1 << minCodeSize;
+	const int END = CLEAR + 1;
+	for (int code = 0; code < CLEAR; code++)
+	{
+		prefix[code] = 0;
+		suffix[code] = static_cast<uint8_t>(code);
+		first[code] = static_cast<uint8_t>(code);
+		length[code] = 1;
+	}
+	int codeSize = minCodeSize + 1;
+	int nextCode = CLEAR + 2;
+	int oldCode = -1;
+	uint32_t bits = 0;
+	int bitCount = 0;
+	size_t position = 0;
+	size_t written = 0;
+	while (written < count)
+	{
+		while (bitCount < codeSize && position < data.size())
+		{
+			bits |= static_cast<uint32_t>(data[position++]) << bitCount;
+			bitCount += 8;
+		}
+		if (bitCount < codeSize)
+			break;
+		const int CODE = bits & ((1 << codeSize) - 1);
+		bits >>= codeSize;
+		bitCount -= codeSize;
+		if (CODE == CLEAR)
+		{
+			codeSize = minCodeSize + 1;
+			nextCode = CLEAR + 2;
+			oldCode = -1;
+			continue;
+		}
+		if (CODE == END)
+			break;
+		if (oldCode < 0)
+		{
+			if (CODE > CLEAR)
+				break; // First code after clear must be a color
+			indexes[written++] = static_cast<uint8_t>(CODE);
+			oldCode = CODE;
+			continue;
+		}
+		if (CODE > nextCode)
+			break;
+		if (nextCode < MAX_CODES)
+		{
+			// Code equal to nextCode is the previous string followed by its own first byte
+			prefix[nextCode] = static_cast<uint16_t>(oldCode);
+			first[nextCode] = first[oldCode];
+			suffix[nextCode] = (CODE == nextCode) ? first[oldCode] : first[CODE];
+			length[nextCode] = length[oldCode] + 1;
+			nextCode++;
+			if (nextCode == (1 << codeSize) && codeSize < 12)
+				codeSize++;
+		}
+		int code = CODE;
+		for (size_t i = length[CODE]; i-- > 0; code = prefix[code])
+			if (written + i < count)
+				indexes[written + i] = suffix[code];
+		written += std::min<size_t>(length[CODE], count - written);
+		oldCode = CODE;
+	}
+	return written;
+}
+bool GIFDecoder::isValid() const
+{
+	return technical.fileState == FileState::VALID_IMAGE_FILE;
+}
+bool GIFDecoder::isFinished() const
+{
+	return finished;
+}
+int GIFDecoder::getWidth() const
+{
+	return width;
+}
+int GIFDecoder::getHeight() const
+{
+	return height;
+}
+int GIFDecoder::getFrameIndex() const
+{
+	return frameIndex;
+}
+const GIFFrame& GIFDecoder::getFrameInfo() const
+{
+	return frame;
+}
+const PixelBuffer& GIFDecoder::getCanvas() const
+{
+	return canvas;
+}
+const std::string& GIFDecoder::getFileStatus() const
+{
+	return technical.technicalMessage;
+}
+} /* namespace consoleartlib */
@@ -0,0 +1,319 @@
+//==============================================================================
+// File       : GIFEncoder.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Encoding RGBA frames into GIF animation
+//==============================================================================
+
+#include "../../consoleartlib/images/formats/gif_encoder.h"
+#include "../../consoleartlib/images/utils/parallel.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+namespace consoleartlib
+{
+GIFEncoder::GIFEncoder(std::ostream& stream, int width, int height, unsigned threads, const ColorQuantizer* globalColors) : stream(stream),
+	width(width), height(height), threads(threads), globalColors(globalColors), written(0), headerWritten(false)
+{
+}
+static void writeShort(PixelBuffer& target, int value)
+{
+	target.push_back(static_cast<uint8_t>(value & 0xFF));
+	target.push_back(static_cast<uint8_t>((value >> 8) & 0xFF));
+}
+/**
+ * @return Bits of color table big enough for colors and transparent index after them
+ */
+static int tableBits(size_t colors)
+{
+	int bits = 1;
+	while ((1u << bits) < colors + 1)
+		bits++;
+	return bits;
+}
+static void writeColorTable(PixelBuffer& target, const std::vector<PixelRGB>& palette, int bits)
+{
+	for (const PixelRGB& color : palette)
+	{
+		target.push_back(color.red);
+		target.push_back(color.green);
+		target.push_back(color.blue);
+	}
+	target.resize(target.size() + 3 * ((size_t(1) << bits) - palette.size()), 0);
+}
+/**
+ * Both transparent counts as unchanged, their colors are never shown.
+ */
+static bool samePixel(const uint8_t* a, const uint8_t* b)
+{
+	return (a[3] < 128 && b[3] < 128) || std::memcmp(a, b, 4) == 0;
+}
+bool GIFEncoder::writeHeader(bool animated)
+{
+	PixelBuffer header;
+	const char SIGNATURE[] = "GIF89a";
+	header.insert(header.end(), SIGNATURE, SIGNATURE + 6);
+	writeShort(header, width);
+	writeShort(header, height);
+	if (globalColors)
+	{
+		const int BITS = tableBits(globalColors->getPalette().size());
+		header.push_back(static_cast<uint8_t>(0xF0 | (BITS - 1)));
+		header.push_back(0); // Background color
+		header.push_back(0); // Aspect ratio
+		writeColorTable(header, globalColors->getPalette(), BITS);
+	}
+	else
+	{
+		header.push_back(0x70);
+		header.push_back(0);
+		header.push_back(0);
+	}
+	if (animated)
+	{
+		// NETSCAPE2.0 extension, loop forever
+		const uint8_t LOOP[] = {0x21, 0xFF, 0x0B, 'N', 'E', 'T', 'S', 'C', 'A', 'P', 'E', '2', '.', '0', 0x03, 0x01, 0x00, 0x00, 0x00};
+		header.insert(header.end(), LOOP, LOOP + sizeof(LOOP));
+	}
+	stream.write(reinterpret_cast<const char*>(header.data()), header.size());
+	headerWritten = true;
+	return static_cast<bool>(stream);
+}
+/**
+ * Crops, quantizes and compresses batch[index]. Reads the frame before it and the flag of the frame after it,
+ * both are ready before frames are encoded in parallel.
+ */
+void GIFEncoder::encodeFrame(size_t index)
+{
+	PendingFrame& pending = batch[index];
+	const uint8_t* before = index ? batch[index - 1].rgba.data() : (written ? previous.data() : nullptr);
+	const bool NEXT_CLEARS = index + 1 < batch.size() && batch[index + 1].clearsPrevious;
+	// Unchanged pixels can be left to the previous frame only when it stays on the canvas
+	const bool KEEPS_PREVIOUS = before && !pending.clearsPrevious;
+	const size_t ROW_SIZE = static_cast<size_t>(width) * 4;
+	int x0 = 0;
+	int y0 = 0;
+	int x1 = width;
+	int y1 = height;
+	if (KEEPS_PREVIOUS && !NEXT_CLEARS)
+	{
+		x0 = width;
+		y0 = height;
+		x1 = 0;
+		y1 = 0;
+		for (int y = 0; y < height; y++)
+		{
+			const uint8_t* row = pending.rgba.data() + y * ROW_SIZE;
+			const uint8_t* previousRow = before + y * ROW_SIZE;
+			for (int x = 0; x < width; x++)
+			{
+				if (samePixel(row + x * 4, previousRow + x * 4))
+					continue;
+				x0 = std::min(x0, x);
+				x1 = std::max(x1, x + 1);
+				y0 = std::min(y0, y);
+				y1 = y + 1;
+			}
+		}
+		if (x1 <= x0)
+		{
+			// Nothing changed, frame still has to be there for its delay
+			x0 = 0;
+			y0 = 0;
+			x1 = 1;
+			y1 = 1;
+		}
+	}
+	auto unchanged = [&](int x, int y)
+	{
+		const size_t OFFSET = y * ROW_SIZE + x * 4;
+		return KEEPS_PREVIOUS && samePixel(pending.rgba.data() + OFFSET, before + OFFSET);
+	};
+	// Histogram bins are large, local quantizer exists only when frames have own palettes
+	std::optional<ColorQuantizer> localColors;
+	if (!globalColors)
+	{
+		localColors.emplace(255);
+		for (int y = y0; y < y1; y++)
+		{
+			for (int x = x0; x < x1; x++)
+			{
+				const uint8_t* pixel = pending.rgba.data() + y * ROW_SIZE + x * 4;
+				if (pixel[3] >= 128 && !unchanged(x, y))
+					localColors->addColor(pixel[0], pixel[1], pixel[2]);
+			}
+		}
+		localColors->buildPalette();
+	}
+	const ColorQuantizer& colors = globalColors ? *globalColors : *localColors;
+	const std::vector<PixelRGB>& palette = colors.getPalette();
+	const uint8_t TRANSPARENT = static_cast<uint8_t>(std::min<size_t>(palette.size(), 255));
+	const int BITS = tableBits(palette.size());
+	PixelBuffer indexes(static_cast<size_t>(x1 - x0) * (y1 - y0));
+	uint8_t* target = indexes.data();
+	for (int y = y0; y < y1; y++)
+	{
+		for (int x = x0; x < x1; x++)
+		{
+			const uint8_t* pixel = pending.rgba.data() + y * ROW_SIZE + x * 4;
+			*target++ = (pixel[3] < 128 || unchanged(x, y)) ? TRANSPARENT : colors.getIndex(pixel[0], pixel[1], pixel[2]);
+		}
+	}
+	PixelBuffer& encoded = pending.encoded;
+	encoded.clear();
+	// Graphic control extension
+	const uint8_t CONTROL[] = {0x21, 0xF9, 0x04, static_cast<uint8_t>(((NEXT_CLEARS ? 2 : 1) << 2) | 0x01)};
+	encoded.insert(encoded.end(), CONTROL, CONTROL + sizeof(CONTROL));
+	writeShort(encoded, std::clamp((pending.delay + 5) / 10, 0, 0xFFFF));
+	encoded.push_back(TRANSPARENT);
+	encoded.push_back(0);
+	// Image descriptor
+	encoded.push_back(0x2C);
+	writeShort(encoded, x0);
+	writeShort(encoded, y0);
+	writeShort(encoded, x1 - x0);
+	writeShort(encoded, y1 - y0);
+	if (globalColors)
+	{
+		encoded.push_back(0);
+	}
+	else
+	{
+		encoded.push_back(static_cast<uint8_t>(0x80 | (BITS - 1)));
+		writeColorTable(encoded, palette, BITS);
+	}
+	encodeLZW(indexes.data(), indexes.size(), std::max(BITS, 2), encoded);
+}
+/**
+ * Encodes first count frames of the batch in parallel and writes them in order,
+ * frame after them (if any) stays in the batch, its flag decided how the last of them is disposed.
+ */
+bool GIFEncoder::writeBatch(size_t count)
+{
+	parallelFor(batch.size(), [this](size_t i)
+	{
+		PendingFrame& pending = batch[i];
+		if (pending.checked)
+			return;
+		const uint8_t* before = i ? batch[i - 1].rgba.data() : (written ? previous.data() : nullptr);
+		pending.clearsPrevious = false;
+		for (size_t offset = 0; before && offset < pending.rgba.size() && !pending.clearsPrevious; offset += 4)
+			pending.clearsPrevious = before[offset + 3] >= 128 && pending.rgba[offset + 3] < 128;
+		pending.checked = true;
+	}, threads);
+	parallelFor(count, [this](size_t i) { encodeFrame(i); }, threads);
+	if (!headerWritten && !writeHeader(written + batch.size() > 1))
+		return false;
+	for (size_t i = 0; i < count; i++)
+		stream.write(reinterpret_cast<const char*>(batch[i].encoded.data()), batch[i].encoded.size());
+	written += count;
+	std::swap(previous, batch[count - 1].rgba);
+	batch.erase(batch.begin(), batch.begin() + count);
+	return static_cast<bool>(stream);
+}
+bool GIFEncoder::addFrame(const uint8_t* rgba, size_t rowStride, int delay)
+{
+	PendingFrame pending;
+	const size_t ROW_SIZE = static_cast<size_t>(width) * 4;
+	pending.rgba.resize(ROW_SIZE * height);
+	for (int y = 0; y < height; y++)
+		std::memcpy(pending.rgba.data() + y * ROW_SIZE, rgba + y * rowStride, ROW_SIZE);
+	pending.delay = delay;
+	batch.push_back(std::move(pending));
+	// Last frame waits for the next one, which decides whether it is cleared
+	const unsigned WORKERS = workerCount(threads, SIZE_MAX);
+	const size_t BATCH_SIZE = (WORKERS > 1) ? 2 * WORKERS : 1;
+	if (batch.size() <= BATCH_SIZE)
+		return static_cast<bool>(stream);
+	return writeBatch(batch.size() - 1);
+}
+bool GIFEncoder::finish()
+{
+	if (!batch.empty() && !writeBatch(batch.size()))
+		return false;
+	if (!headerWritten && !writeHeader(false))
+		return false;
+	stream.put(0x3B);
+	stream.flush();
+	return static_cast<bool>(stream);
+}
+/**
+ * Strings are found in open addressing hash table keyed by prefix code and next index.
+ * Table is cleared when it reaches 4096 codes.
+ */
+void GIFEncoder::encodeLZW(const uint8_t* indexes, size_t count, int minCodeSize, PixelBuffer& target)
+{
+	constexpr int MAX_CODES = 4096;
+	constexpr size_t HASH_SIZE = 8192;
+	std::vector<uint32_t> keys(HASH_SIZE, 0); // Key + 1, zero is an empty slot
+	std::vector<uint16_t> codes(HASH_SIZE);
+	const int CLEAR = 1 << minCodeSize;
+	const int END = CLEAR + 1;
+	int codeSize = minCodeSize + 1;
+	int nextCode = CLEAR + 2;
+	PixelBuffer data;
+	uint32_t bits = 0;
+	int bitCount = 0;
+	auto emit = [&](int code)
+	{
+		bits |= static_cast<uint32_t>(code) << bitCount;
+		bitCount += codeSize;
+		while (bitCount >= 8)
+		{
+			data.push_back(static_cast<uint8_t>(bits & 0xFF));
+			bits >>= 8;
+			bitCount -= 8;
+		}
+	};
+	emit(CLEAR);
+	if (count > 0)
+	{
+		int prefix = indexes[0];
+		for (size_t i = 1; i < count; i++)
+		{
+			const uint32_t KEY = (static_cast<uint32_t>(prefix) << 8 | indexes[i]) + 1;
+			size_t slot = (KEY * 2654435761u) >> 19;
+			while (keys[slot] && keys[slot] != KEY)
+				slot = (slot + 1) & (HASH_SIZE - 1);
+			if (keys[slot])
+			{
+				prefix = codes[slot];
+				continue;
+			}
+			emit(prefix);
+			if (nextCode < MAX_CODES)
+			{
+				keys[slot] = KEY;
+				codes[slot] = static_cast<uint16_t>(nextCode++);
+				// Decoder adds the same code one code later, so the size grows once the new code doesn't fit
+				if (nextCode > (1 << codeSize) && codeSize < 12)
+					codeSize++;
+			}
+			else
+			{
+				emit(CLEAR);
+				std::fill(keys.begin(), keys.end(), 0);
+				codeSize = minCodeSize + 1;
+				nextCode = CLEAR + 2;
+			}
+			prefix = indexes[i];
+		}
+		emit(prefix);
+	}
+	emit(END);
+	if (bitCount > 0)
+		data.push_back(static_cast<uint8_t>(bits & 0xFF));
+	target.push_back(static_cast<uint8_t>(minCodeSize));
+	for (size_t offset = 0; offset < data.size(); offset += 255)
+	{
+		const size_t SIZE = std::min<size_t>(255, data.size() - offset);
+		target.push_back(static_cast<uint8_t>(SIZE));
+		target.insert(target.end(), data.begin() + offset, data.begin() + offset + SIZE);
+	}
+	target.push_back(0);
+}
+} /* namespace consoleartlib */
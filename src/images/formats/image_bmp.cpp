@@ -2,7 +2,7 @@
 // Name        : ImageBMP
 // Author      : Riyufuchi
 // Created on  : Jul 17, 2020
-// Last Edited : Dec 16, 2025
+// Last Edited : Oct 17, 2026
 // Description : This class is responsible for loading uncompressed 24-bit or 32-bit BMP image files.
 //               It provides functionality to read BMP files, including the file header, BMP information,
 //               and color data. The image must have the origin in the bottom left corner.
@@ -12,20 +12,61 @@
 
 namespace consoleartlib
 {
-ImageBMP::ImageBMP(const std::string& filename) : Image(filename, ImageType::BMP)
+ImageBMP::ImageBMP(const std::string& filename, const LoadOptions& options) : Image(filename, ImageType::BMP, options)
 {
-	loadImage();
-	image.width = bmp_info_header.width;
-	image.height = bmp_info_header.height;
-	image.file_type = headerBMP.file_type;
-	image.bits = bmp_info_header.bit_count;
-	image.channels = bmp_info_header.bit_count / 8;
 	image.pixelByteOrder = PixelByteOrder::BGRA;
+	if (options.deferDecode)
+	{
+		deferDecode(probe(filepath, image, options.source));
+		if (options.uprightRows)
+			image.inverted = false;
+	}
+	else
+	{
+		loadImage();
+	}
+}
+/**
+ * Reads only file and info headers.
+ */
+TechnicalInfo ImageBMP::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	TechnicalInfo technical;
+	SourceStream inf(filepath, source);
+	if (!inf)
+	{
+		technical.technicalMessage = "Unable to open file: " + filepath;
+		return technical;
+	}
+	BMPFileHeader fileHeader;
+	BMPInfoHeader infoHeader;
+	inf.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader));
+	inf.read(reinterpret_cast<char*>(&infoHeader), sizeof(infoHeader));
+	if (!inf || fileHeader.file_type != 0x4D42)
+	{
+		technical.technicalMessage = "Error: Unrecognized format";
+		return technical;
+	}
+	if (infoHeader.bit_count != 24 && infoHeader.bit_count != 32)
+	{
+		technical.technicalMessage = "This reader dosn't support " + std::to_string(infoHeader.bit_count) + "-bit images.";
+		return technical;
+	}
+	info.width = infoHeader.width;
+	info.height = std::abs(infoHeader.height); // Negative for top-down files
+	info.file_type = fileHeader.file_type;
+	info.bits = infoHeader.bit_count;
+	info.channels = infoHeader.bit_count / 8;
+	info.pixelByteOrder = PixelByteOrder::BGRA;
+	info.inverted = infoHeader.height > 0;
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
 }
 
 void ImageBMP::loadImage()
 {
-	std::ifstream inf(filepath, std::ios::in);
+	SourceStream inf(filepath, options.source);
 	if (!inf)
 	{
 		this->technical.technicalMessage = "Unable to open file: " + image.name;
@@ -40,36 +81,85 @@ void ImageBMP::loadImage()
 		this->technical.technicalMessage = e.what();
 		return;
 	}
-	readImageData(inf);
-	// Check for image orientation
+	const ImageRegion REGION = clipRegion(options.region, bmp_info_header.width, std::abs(bmp_info_header.height));
+	if (REGION.isEmpty())
+	{
+		this->technical.technicalMessage = "Region lies outside of the image";
+		return;
+	}
+	image.width = reducedSize(REGION.width, options.downscale);
+	image.height = reducedSize(REGION.height, options.downscale);
+	image.file_type = headerBMP.file_type;
+	image.bits = bmp_info_header.bit_count;
+	image.channels = bmp_info_header.bit_count / 8;
+	image.pixelByteOrder = PixelByteOrder::BGRA;
+	if (!readImageData(inf, REGION))
+	{
+		invalidate("Unexpected end of pixel data");
+		return;
+	}
+	// Check for image orientation, header now describes the order of rows in memory
 	this->image.inverted = bmp_info_header.height > 0; // Origin is in bottom left corner, if this turns to be false
 	this->technical.fileState = FileState::VALID_IMAGE_FILE;
 }
-void ImageBMP::readImageData(std::ifstream& inf)
+/**
+ * Reads only rows of the region, stream must be at the start of pixel array. Whole block is taken at once,
+ * padding is stripped, rows are flipped (options.uprightRows) and averaged (options.downscale) in the same pass.
+ * Headers are rewritten to describe the image in memory, so it saves as a standalone file.
+ * @return false when the file ends before the last row of the region
+ */
+bool ImageBMP::readImageData(std::istream& inf, const ImageRegion& region)
 {
-	headerBMP.file_size = headerBMP.offset_data;
-	pixelData.resize(bmp_info_header.width * bmp_info_header.height * bmp_info_header.bit_count / 8);
-	if (bmp_info_header.width % 4 == 0)
+	const bool TOP_DOWN = bmp_info_header.height < 0;
+	const bool FLIP = !TOP_DOWN && options.uprightRows;
+	const int FILE_HEIGHT = std::abs(bmp_info_header.height);
+	const size_t PIXEL_SIZE = bmp_info_header.bit_count / 8;
+	row_stride = bmp_info_header.width * PIXEL_SIZE;
+	const uint32_t FILE_STRIDE = makeStrideAligned(4);
+	// Rows of bottom-up files are stored from the last one, so the region starts after the rows below it
+	const uint64_t SKIPPED_ROWS = TOP_DOWN ? region.y : FILE_HEIGHT - region.y - region.height;
+	if (SKIPPED_ROWS > 0)
+		inf.seekg(SKIPPED_ROWS * FILE_STRIDE, std::ios::cur);
+	const bool WHOLE_ROWS = region.width == bmp_info_header.width;
+	const size_t SOURCE_ROW = region.width * PIXEL_SIZE;
+	bmp_info_header.width = image.width;
+	bmp_info_header.height = (TOP_DOWN || FLIP) ? -image.height : image.height;
+	row_stride = image.width * PIXEL_SIZE;
+	const size_t STRIDE = getRowStride();
+	pixelData.resize(STRIDE * image.height);
+	PixelBuffer scratch(pixelData.get_allocator());
+	const std::span<const uint8_t> block = readBlock(inf, static_cast<size_t>(FILE_STRIDE) * region.height, scratch);
+	const size_t FIRST = region.x * PIXEL_SIZE;
+	// Padding after the last row is often left out
+	if (block.size() < (region.height - 1) * static_cast<size_t>(FILE_STRIDE) + FIRST + SOURCE_ROW)
+		return false;
+	if (options.downscale > 1)
 	{
-		inf.read(reinterpret_cast<char*>(pixelData.data()), pixelData.size());
-		headerBMP.file_size += pixelData.size();
+		// Blocks of averaged rows are counted from the top row of the region, whatever order the rows come in
+		const int SCALE = options.downscale;
+		BoxFilter<uint8_t> filter(region.width, PIXEL_SIZE, SCALE);
+		for (int y = 0; y < region.height; ++y)
+		{
+			const int UPRIGHT = TOP_DOWN ? y : region.height - 1 - y;
+			filter.addRow(block.data() + y * FILE_STRIDE + FIRST);
+			if (TOP_DOWN ? ((UPRIGHT + 1) % SCALE == 0 || UPRIGHT == region.height - 1) : UPRIGHT % SCALE == 0)
+				filter.flushRow(pixelData.data() + STRIDE * (bmp_info_header.height < 0 ? UPRIGHT / SCALE : image.height - 1 - UPRIGHT / SCALE));
+		}
+	}
+	else if (FILE_STRIDE == STRIDE && WHOLE_ROWS && !FLIP)
+	{
+		std::memcpy(pixelData.data(), block.data(), std::min(block.size(), pixelData.size()));
 	}
 	else
 	{
-		row_stride = bmp_info_header.width * bmp_info_header.bit_count / 8;
-		uint32_t new_stride = makeStrideAligned(4);
-		std::vector<uint8_t> padding_row(new_stride - row_stride);
-		for (int y = 0; y < bmp_info_header.height; ++y)
-		{
-			inf.read(reinterpret_cast<char*>(pixelData.data() + row_stride * y), row_stride);
-			inf.read(reinterpret_cast<char*>(padding_row.data()), padding_row.size());
-		}
-		headerBMP.file_size += pixelData.size() + bmp_info_header.height * padding_row.size();
-		//headerBMP.file_size = headerBMP.offset_data + (row_stride + padding_row) * bmp_info_header.height;
-
+		// File rows are padded to 4 bytes, memory rows to the requested alignment
+		for (int y = 0; y < region.height; ++y)
+			std::memcpy(pixelData.data() + STRIDE * (FLIP ? region.height - 1 - y : y), block.data() + y * FILE_STRIDE + FIRST, row_stride);
 	}
+	headerBMP.file_size = headerBMP.offset_data + makeStrideAligned(4) * image.height;
+	return true;
 }
-void ImageBMP::checkHeader(std::ifstream& inf)
+void ImageBMP::checkHeader(std::istream& inf)
 {
 	inf.read(reinterpret_cast<char*>(&headerBMP), sizeof(headerBMP)); //Reads and fill our file_header struct with data
 	if (headerBMP.file_type != 0x4D42)
@@ -136,9 +226,40 @@ uint32_t ImageBMP::makeStrideAligned(uint32_t align_stride)
 	return new_stride;
 }
 
+bool ImageBMP::acceptLayout(ImageInfo& layout)
+{
+	const uint16_t BIT_COUNT = (layout.channels == 4 || layout.channels == 2) ? 32 : 24;
+	headerBMP = BMPFileHeader();
+	bmp_info_header = BMPInfoHeader();
+	bmp_color_header = BMPColorHeader();
+	bmp_info_header.width = layout.width;
+	bmp_info_header.height = layout.height;
+	bmp_info_header.bit_count = BIT_COUNT;
+	if (BIT_COUNT == 32)
+	{
+		bmp_info_header.compression = 3;
+		bmp_info_header.size = sizeof(BMPInfoHeader) + sizeof(BMPColorHeader);
+		headerBMP.offset_data = sizeof(BMPFileHeader) + sizeof(BMPInfoHeader) + sizeof(BMPColorHeader);
+	}
+	else
+	{
+		bmp_info_header.size = sizeof(BMPInfoHeader);
+		headerBMP.offset_data = sizeof(BMPFileHeader) + sizeof(BMPInfoHeader);
+	}
+	row_stride = layout.width * BIT_COUNT / 8;
+	headerBMP.file_size = headerBMP.offset_data + makeStrideAligned(4) * layout.height;
+	layout.channels = BIT_COUNT / 8;
+	layout.bits = BIT_COUNT;
+	layout.file_type = headerBMP.file_type;
+	layout.pixelByteOrder = PixelByteOrder::BGRA;
+	layout.planar = false;
+	layout.inverted = true; // Stored bottom-up
+	return true;
+}
 Pixel ImageBMP::getPixel(int x, int y) const
 {
-	x = image.channels * (y * bmp_info_header.width + x);
+	ensureDecoded();
+	x = y * getRowStride() + x * image.channels;
 	if (image.channels == 4)
 		return {pixelData[x + 2], pixelData[x + 1], pixelData[x], pixelData[x + 3]};
 	else
@@ -146,7 +267,8 @@ Pixel ImageBMP::getPixel(int x, int y) const
 }
 void ImageBMP::setPixel(int x, int y, Pixel newPixel)
 {
-	x = image.channels * (y * bmp_info_header.width + x);
+	ensureDecoded();
+	x = y * getRowStride() + x * image.channels;
 	pixelData[x] = newPixel.blue;
 	pixelData[x + 1] = newPixel.green;
 	pixelData[x + 2] = newPixel.red;
@@ -155,26 +277,31 @@ void ImageBMP::setPixel(int x, int y, Pixel newPixel)
 }
 uint8_t ImageBMP::getRed(int x, int y) const
 {
-	return pixelData[image.channels * (y * bmp_info_header.width + x) + 2]; //static_cast<int>(pixelData[x])
+	ensureDecoded();
+	return pixelData[y * getRowStride() + x * image.channels + 2]; //static_cast<int>(pixelData[x])
 }
 uint8_t ImageBMP::getGreen(int x, int y) const
 {
-	return pixelData[image.channels * (y * bmp_info_header.width + x) + 1];
+	ensureDecoded();
+	return pixelData[y * getRowStride() + x * image.channels + 1];
 }
 uint8_t ImageBMP::getBlue(int x, int y) const
 {
-	return pixelData[image.channels * (y * bmp_info_header.width + x)];
+	ensureDecoded();
+	return pixelData[y * getRowStride() + x * image.channels];
 }
 
 uint8_t ImageBMP::getAplha(int x, int y) const
 {
+	ensureDecoded();
 	if (image.channels == 4)
-		return pixelData[image.channels * (y * bmp_info_header.width + x) + 3];
+		return pixelData[y * getRowStride() + x * image.channels + 3];
 	else
 		return 255;
 }
 bool ImageBMP::saveImage() const
 {
+	ensureDecoded();
 	std::ofstream outf(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
 	if (!outf.is_open())
 	{
@@ -189,26 +316,183 @@ bool ImageBMP::saveImage() const
 		outf.write(reinterpret_cast<const char*>(&bmp_color_header), sizeof(BMPColorHeader));
 	}
 
-	// Handle row padding
-	const int row_stride = bmp_info_header.width * bmp_info_header.bit_count / 8;
-	const int padding_size = (4 - (row_stride % 4)) % 4;
-	const std::vector<uint8_t> padding(padding_size, 0);
-
-	// Write pixel data with padding
-	for (int y = 0; y < bmp_info_header.height; ++y)
+	// Rows are written in memory order, header height tells which one it is
+	const size_t ROW_SIZE = static_cast<size_t>(image.width) * image.channels;
+	const size_t FILE_STRIDE = (ROW_SIZE + 3) & ~static_cast<size_t>(3);
+	const size_t STRIDE = getRowStride();
+	if (STRIDE == FILE_STRIDE)
 	{
-		outf.write(reinterpret_cast<const char*>(pixelData.data() + y * row_stride), row_stride);
-		if (padding_size > 0)
-		{
-			outf.write(reinterpret_cast<const char*>(padding.data()), padding_size);
-		}
+		// Memory rows have the file padding already, pixel array goes out in one write
+		outf.write(reinterpret_cast<const char*>(pixelData.data()), FILE_STRIDE * image.height);
+		return static_cast<bool>(outf);
 	}
-
-	return true;
+	// Padded rows are gathered into chunks, so the stream gets one large write per chunk instead of two per row
+	constexpr size_t CHUNK_SIZE = 1 << 20;
+	const int CHUNK_ROWS = static_cast<int>(std::max<size_t>(CHUNK_SIZE / FILE_STRIDE, 1));
+	std::vector<uint8_t> chunk(FILE_STRIDE * std::min(CHUNK_ROWS, image.height), 0);
+	for (int y = 0; y < image.height; y += CHUNK_ROWS)
+	{
+		const int ROWS = std::min(CHUNK_ROWS, image.height - y);
+		for (int row = 0; row < ROWS; row++)
+			std::memcpy(chunk.data() + row * FILE_STRIDE, pixelData.data() + (y + row) * STRIDE, ROW_SIZE);
+		outf.write(reinterpret_cast<const char*>(chunk.data()), FILE_STRIDE * ROWS);
+	}
+	return static_cast<bool>(outf);
 }
 
 ImageBMP::~ImageBMP()
 {
 	std::cout << "Image: " << image.name << " destructed successfully" << std::endl;
 }
+/**
+ * Reads rows straight from their offsets in the file, bottom-up files are returned top-down.
+ */
+class BandReaderBMP : public BandReader
+{
+private:
+	uint64_t dataOffset;
+	uint32_t fileStride;
+	bool bottomUp;
+	PixelBuffer scratch;
+protected:
+	bool decodeRows(uint8_t* rows, int count) override
+	{
+		const size_t ROW_SIZE = format.rowStride;
+		// Rows of one band are neighbors in the file, only their order may be reversed
+		const uint64_t FIRST = bottomUp ? info.height - nextRow - count : nextRow;
+		stream.clear();
+		stream.seekg(static_cast<std::streamoff>(dataOffset + FIRST * fileStride));
+		const std::span<const uint8_t> block = readBlock(stream, static_cast<size_t>(fileStride) * count, scratch);
+		if (block.size() < static_cast<size_t>(fileStride) * (count - 1) + ROW_SIZE) // Padding of the last row may be missing
+		{
+			technical.technicalMessage = "Unexpected end of pixel data";
+			return false;
+		}
+		for (int i = 0; i < count; i++)
+			std::memcpy(rows + (bottomUp ? count - 1 - i : i) * ROW_SIZE, block.data() + static_cast<size_t>(i) * fileStride, ROW_SIZE);
+		return true;
+	}
+public:
+	BandReaderBMP(const std::string& filepath, int bandHeight, const LoadOptions& options) : BandReader(filepath, bandHeight, options),
+		dataOffset(0), fileStride(0), bottomUp(true), scratch(band.get_allocator())
+	{
+		if (!stream)
+			return;
+		ImageBMP::BMPFileHeader fileHeader;
+		ImageBMP::BMPInfoHeader infoHeader;
+		stream.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader));
+		stream.read(reinterpret_cast<char*>(&infoHeader), sizeof(infoHeader));
+		if (!stream || fileHeader.file_type != 0x4D42)
+		{
+			technical.technicalMessage = "Error: Unrecognized format";
+			return;
+		}
+		if ((infoHeader.bit_count != 24 && infoHeader.bit_count != 32) || (infoHeader.compression != 0 && infoHeader.compression != 3))
+		{
+			technical.technicalMessage = "This reader dosn't support " + std::to_string(infoHeader.bit_count) + "-bit or compressed images.";
+			return;
+		}
+		if (infoHeader.width <= 0 || infoHeader.height == 0)
+		{
+			technical.technicalMessage = "Invalid image size";
+			return;
+		}
+		info.width = infoHeader.width;
+		info.height = (infoHeader.height > 0) ? infoHeader.height : -infoHeader.height;
+		info.bits = infoHeader.bit_count;
+		info.channels = infoHeader.bit_count / 8;
+		info.file_type = fileHeader.file_type;
+		info.pixelByteOrder = PixelByteOrder::BGRA;
+		info.imageFormat = ImageType::BMP;
+		bottomUp = infoHeader.height > 0;
+		dataOffset = fileHeader.offset_data;
+		fileStride = (static_cast<uint32_t>(info.width) * info.channels + 3) & ~3u;
+		format.channels = info.channels;
+		format.pixelByteOrder = PixelByteOrder::BGRA;
+		format.pixelStride = info.channels;
+		format.channelStride = 1;
+		format.rowStride = static_cast<size_t>(info.width) * info.channels;
+		technical.technicalMessage = "Header loaded";
+		technical.fileState = FileState::VALID_IMAGE_FILE;
+	}
+};
+/**
+ * Writes headers first, then puts every band to its place from the end of the file, as BMP rows go bottom-up.
+ */
+class BandWriterBMP : public BandWriter
+{
+private:
+	uint64_t dataOffset; // Target stream may already hold something before the image
+	uint32_t fileStride;
+protected:
+	bool encodeRows(const uint8_t* rows, int count) override
+	{
+		const size_t ROW_SIZE = format.rowStride;
+		const uint8_t PADDING[4] {};
+		out.seekp(static_cast<std::streamoff>(dataOffset + static_cast<uint64_t>(info.height - rowsWritten - count) * fileStride));
+		for (int i = count - 1; i >= 0; i--)
+		{
+			out.write(reinterpret_cast<const char*>(rows + i * ROW_SIZE), ROW_SIZE);
+			out.write(reinterpret_cast<const char*>(PADDING), fileStride - ROW_SIZE);
+		}
+		return static_cast<bool>(out);
+	}
+public:
+	BandWriterBMP(const std::string& filepath, int width, int height, int channels, std::ostream* target) : BandWriter(filepath, width, height, target),
+		dataOffset(0), fileStride(0)
+	{
+		const uint16_t BIT_COUNT = (channels == 4 || channels == 2) ? 32 : 24;
+		info.channels = BIT_COUNT / 8;
+		info.bits = BIT_COUNT;
+		info.pixelByteOrder = PixelByteOrder::BGRA;
+		info.imageFormat = ImageType::BMP;
+		info.inverted = true;
+		format.channels = info.channels;
+		format.pixelByteOrder = PixelByteOrder::BGRA;
+		format.pixelStride = info.channels;
+		format.channelStride = 1;
+		format.rowStride = static_cast<size_t>(width) * info.channels;
+		if (!isValid())
+			return;
+		ImageBMP::BMPFileHeader fileHeader;
+		ImageBMP::BMPInfoHeader infoHeader;
+		ImageBMP::BMPColorHeader colorHeader;
+		infoHeader.width = width;
+		infoHeader.height = height;
+		infoHeader.bit_count = BIT_COUNT;
+		if (BIT_COUNT == 32)
+		{
+			infoHeader.compression = 3;
+			infoHeader.size = sizeof(ImageBMP::BMPInfoHeader) + sizeof(ImageBMP::BMPColorHeader);
+			fileHeader.offset_data = sizeof(ImageBMP::BMPFileHeader) + sizeof(ImageBMP::BMPInfoHeader) + sizeof(ImageBMP::BMPColorHeader);
+		}
+		else
+		{
+			infoHeader.size = sizeof(ImageBMP::BMPInfoHeader);
+			fileHeader.offset_data = sizeof(ImageBMP::BMPFileHeader) + sizeof(ImageBMP::BMPInfoHeader);
+		}
+		dataOffset = static_cast<uint64_t>(out.tellp()) + fileHeader.offset_data;
+		fileStride = (static_cast<uint32_t>(width) * info.channels + 3) & ~3u;
+		const uint64_t FILE_SIZE = dataOffset + static_cast<uint64_t>(fileStride) * height;
+		if (FILE_SIZE > UINT32_MAX)
+		{
+			technical.technicalMessage = "Image is too large for BMP";
+			technical.fileState = FileState::INVALID_IMAGE_FILE;
+			return;
+		}
+		fileHeader.file_size = static_cast<uint32_t>(FILE_SIZE);
+		out.write(reinterpret_cast<const char*>(&fileHeader), sizeof(fileHeader));
+		out.write(reinterpret_cast<const char*>(&infoHeader), sizeof(infoHeader));
+		if (BIT_COUNT == 32)
+			out.write(reinterpret_cast<const char*>(&colorHeader), sizeof(colorHeader));
+	}
+};
+std::unique_ptr<BandReader> ImageBMP::openBandReader(const std::string& filepath, int bandHeight, const LoadOptions& options)
+{
+	return std::make_unique<BandReaderBMP>(filepath, bandHeight, options);
+}
+std::unique_ptr<BandWriter> ImageBMP::createBandWriter(const std::string& filepath, int width, int height, int channels, std::ostream* target)
+{
+	return std::make_unique<BandWriterBMP>(filepath, width, height, channels, target);
+}
 }
@@ -2,26 +2,75 @@
 // File       : ImageDCX.cpp
 // Author     : riyufuchi
 // Created on : Nov 13, 2025
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
 
 #include "../../consoleartlib/images/formats/image_dcx.h"
+#include "../../consoleartlib/images/utils/parallel.hpp"
 
 namespace consoleartlib
 {
 
-ImageDCX::ImageDCX(const std::string& filename) : Image(filename, ImageType::DCX), selectedPage(0)
+ImageDCX::ImageDCX(const std::string& filename, const LoadOptions& options) : Image(filename, ImageType::DCX, options), selectedPage(0), pageCheckedOut(false),
+	numOfPages(0), cachedBytes(0), useCounter(0)
 {
 	image.multipage = true;
 	image.planar = true;
-	loadImage();
+	this->options.rowAlignment = 0; // Planes keep the file layout, only the buffer stays aligned
+	if (options.deferDecode)
+		deferDecode(probe(filepath, image, options.source));
+	else
+		loadImage();
+}
+/**
+ * Reads magic number, first page offset and header of the first page.
+ */
+TechnicalInfo ImageDCX::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	TechnicalInfo technical;
+	SourceStream stream(filepath, source);
+	if (!stream)
+	{
+		technical.technicalMessage = "Unable to open file: " + filepath;
+		return technical;
+	}
+	uint32_t magic = 0;
+	uint32_t firstPage = 0;
+	stream.read(reinterpret_cast<char*>(&magic), 4);
+	stream.read(reinterpret_cast<char*>(&firstPage), 4);
+	if (!stream || magic != MAGIC || firstPage == 0)
+	{
+		technical.technicalMessage = "Not a DCX file or DCX without pages";
+		return technical;
+	}
+	stream.seekg(firstPage);
+	ImagePCX::HeaderPCX header;
+	ImagePCX::readHeader(stream, header, info);
+	try
+	{
+		if (!stream)
+			throw std::runtime_error("Incomplete header of first page");
+		ImagePCX::checkHeader(header, info);
+	}
+	catch (std::runtime_error& e)
+	{
+		technical.technicalMessage = e.what();
+		return technical;
+	}
+	ImagePCX::probeHeader(header, info);
+	info.multipage = true;
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
 }
 
-ImageDCX::ImageDCX(const std::string& filename, int numberOfPages) : Image(filename, ImageType::DCX), selectedPage(0), numOfPages(numberOfPages)
+ImageDCX::ImageDCX(const std::string& filename, int numberOfPages) : Image(filename, ImageType::DCX), selectedPage(0), pageCheckedOut(false),
+	numOfPages(numberOfPages), cachedBytes(0), useCounter(0)
 {
 	pages.reserve(numberOfPages);
+	pageStates.reserve(numberOfPages);
 }
 
 ImageDCX::~ImageDCX()
@@ -30,13 +79,13 @@ ImageDCX::~ImageDCX()
 
 void ImageDCX::loadImage()
 {
-	std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+	SourceStream stream(filepath, options.source);
 	if (!stream)
 		return;
 	// --- Read magic ---
 	uint32_t magic = 0;
 	stream.read(reinterpret_cast<char*>(&magic), 4);
-	if (magic != 0x3ADE68B1) // DCX is little-endian
+	if (magic != MAGIC) // DCX is little-endian
 		return; // not a DCX file
 	// --- Read offset table ---
 	std::vector<uint32_t> offsets;
@@ -53,6 +102,12 @@ void ImageDCX::loadImage()
 
 	if (offsets.empty())
 		return; // DCX with no PCX pages
+	ranges.clear();
+	pages.clear();
+	pageStates.clear();
+	cachedBytes = 0;
+	pageCheckedOut = false;
+	sourcePath = filepath;
 
 	// --- Calculate ranges ---
 	ImageRange r;
@@ -70,101 +125,329 @@ void ImageDCX::loadImage()
 		ranges.push_back(r);
 	}
 
-	// --- Load images ---
+	// --- Pages are decoded when they are needed ---
 	numOfPages = ranges.size();
-	ImagePCX::PagePCX page;
-	for (const ImageRange& range : ranges)
+	for (size_t i = 0; i < ranges.size(); ++i)
+		pages.push_back({ ImagePCX::HeaderPCX(), image, PixelBuffer(getMemoryResource()), "Not decoded", {} });
+	pageStates.resize(ranges.size());
+	selectPage(0);
+	if (!pageCheckedOut)
+	{
+		technical.technicalMessage = pages[0].msg;
+		return;
+	}
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+}
+/**
+ * Decodes page from the file into page, which keeps its memory resource.
+ */
+bool ImageDCX::readPage(size_t index, ImagePCX::PagePCX& page) const
+{
+	SourceStream stream(sourcePath, options.source);
+	if (!stream)
+	{
+		page.msg = "Unable to open file: " + sourcePath;
+		return false;
+	}
+	stream.seekg(ranges[index].start);
+	page.image = image;
+	if (!ImagePCX::readPCX(stream, page, ranges[index].start, ranges[index].end, options.region, options.downscale))
+		return false;
+	page.image.name = getFilename();
+	page.msg = "OK";
+	return true;
+}
+/**
+ * Encoded page as it will be saved, without decoding it when the file already has it that way.
+ */
+bool ImageDCX::readEncodedPage(size_t index, PixelBuffer& data) const
+{
+	if (options.region.isEmpty() && options.downscale == 1)
 	{
-		stream.seekg(range.start);
-		page.image = image;
-		if (ImagePCX::readPCX(stream, page, range.start, range.end))
+		SourceStream stream(sourcePath, options.source);
+		data.resize(ranges[index].size());
+		stream.seekg(ranges[index].start);
+		stream.read(reinterpret_cast<char*>(data.data()), data.size());
+		return static_cast<bool>(stream);
+	}
+	// Temporary page, default resource is safe to use from several threads
+	ImagePCX::PagePCX page { ImagePCX::HeaderPCX(), image, PixelBuffer(), "", {} };
+	return readPage(index, page) && ImagePCX::encodePCX(page.header, page.pixelData, data);
+}
+/**
+ * Makes page the most recently used one, decoding it when it isn't cached.
+ */
+bool ImageDCX::decodePage(size_t index)
+{
+	pageStates[index].lastUse = ++useCounter;
+	if (pageStates[index].decoded)
+		return true;
+	if (!readPage(index, pages[index]))
+		return false;
+	cachePage(index);
+	evictPages();
+	return true;
+}
+void ImageDCX::cachePage(size_t index)
+{
+	PageState& state = pageStates[index];
+	state.decoded = true;
+	state.bytes = pages[index].pixelData.size();
+	state.lastUse = ++useCounter;
+	cachedBytes += state.bytes;
+}
+/**
+ * Arena resource is not thread safe, pages allocated from it are decoded one at a time.
+ */
+unsigned ImageDCX::pageThreads() const
+{
+	return dynamic_cast<ArenaResource*>(options.memoryResource) ? 1 : options.threads;
+}
+void ImageDCX::decodePages(size_t first, size_t count)
+{
+	ensureDecoded();
+	std::vector<size_t> missing;
+	for (size_t i = first; i < pages.size() && i - first < count; ++i)
+		if (!pageStates[i].decoded)
+			missing.push_back(i);
+	// Every page has its own stream and buffer, the cache is updated after all of them are done
+	std::vector<uint8_t> decoded(missing.size(), false);
+	parallelFor(missing.size(), [&](size_t i)
+	{
+		decoded[i] = readPage(missing[i], pages[missing[i]]);
+	}, pageThreads());
+	for (size_t i = 0; i < missing.size(); ++i)
+		if (decoded[i])
+			cachePage(missing[i]);
+	evictPages();
+}
+/**
+ * Drops least recently used pages until the cache fits its budget.
+ * The selected page, the page used last and pinned pages stay.
+ */
+void ImageDCX::evictPages()
+{
+	if (options.pageCacheBytes == 0)
+		return;
+	while (cachedBytes > options.pageCacheBytes)
+	{
+		size_t victim = pages.size();
+		for (size_t i = 0; i < pageStates.size(); ++i)
 		{
-			page.image.name = getFilename();
-			pages.emplace_back(page);
+			const PageState& state = pageStates[i];
+			if (!state.decoded || state.pinned || state.lastUse == useCounter || (pageCheckedOut && i == selectedPage))
+				continue;
+			if (victim == pages.size() || state.lastUse < pageStates[victim].lastUse)
+				victim = i;
 		}
+		if (victim == pages.size())
+			return;
+		pages[victim].pixelData = PixelBuffer(getMemoryResource());
+		pageStates[victim].decoded = false;
+		cachedBytes -= pageStates[victim].bytes;
 	}
-	selectPage(0);
-	technical.fileState = FileState::VALID_IMAGE_FILE;
+}
+ScanlineFormat ImageDCX::getScanlineFormat() const
+{
+	ScanlineFormat format;
+	format.channels = headerPCX.numOfColorPlanes;
+	format.pixelStride = 1;
+	format.channelStride = headerPCX.bytesPerLine;
+	format.rowStride = static_cast<size_t>(headerPCX.bytesPerLine) * headerPCX.numOfColorPlanes;
+	return format;
 }
 Pixel ImageDCX::getPixel(int x, int y) const
 {
+	ensureDecoded();
 	x = (y * headerPCX.bytesPerLine * headerPCX.numOfColorPlanes) + x;
 	Pixel pixel;
 	switch (headerPCX.numOfColorPlanes)
 	{
 		case 4:
-			pixel.alpha = pixelData[x + 3 * image.width];
-			/* no break */
+			pixel.alpha = pixelData[x + 3 * headerPCX.bytesPerLine];
+			[[fallthrough]];
 		case 3:
 			pixel.red = pixelData[x];
 			pixel.green = pixelData[x + headerPCX.bytesPerLine];
-			pixel.blue = pixelData[x + 2 * image.width];
+			pixel.blue = pixelData[x + 2 * headerPCX.bytesPerLine];
 		break;
 	}
 	return pixel;
 }
 void ImageDCX::setPixel(int x, int y, Pixel newPixel)
 {
-	x = y * 3 * image.width + x;
+	ensureDecoded();
+	markModified();
+	x = (y * headerPCX.bytesPerLine * headerPCX.numOfColorPlanes) + x;
 	switch (headerPCX.numOfColorPlanes)
 	{
 		case 4:
-			pixelData[x + 3 * image.width] = newPixel.alpha;
-			/* no break */
+			pixelData[x + 3 * headerPCX.bytesPerLine] = newPixel.alpha;
+			[[fallthrough]];
 		case 3:
 			pixelData[x] = newPixel.red;
-			pixelData[x + image.width]= newPixel.green;
-			pixelData[x + 2 * image.width] = newPixel.blue;
+			pixelData[x + headerPCX.bytesPerLine]= newPixel.green;
+			pixelData[x + 2 * headerPCX.bytesPerLine] = newPixel.blue;
 		break;
 	}
 }
 bool ImageDCX::saveImage() const
 {
+	ensureDecoded();
 	if (pages.empty())
 		return false;
+	// Pages are encoded concurrently into their own buffers (uncached ones are read from the source),
+	// all before the file is created, as it may be the file they come from
+	const size_t COUNT = pages.size();
+	std::vector<const PixelBuffer*> pixels(COUNT, nullptr);
+	for (size_t i = 0; i < COUNT; ++i)
+		if (pageStates[i].decoded)
+			pixels[i] = &getPagePixels(i);
+	std::vector<PixelBuffer> encodedPages(COUNT);
+	std::vector<uint8_t> encoded(COUNT, false);
+	parallelFor(COUNT, [&](size_t i)
+	{
+		encoded[i] = pixels[i] ? ImagePCX::encodePCX(pages[i].header, *pixels[i], encodedPages[i]) : readEncodedPage(i, encodedPages[i]);
+	}, pageThreads());
+	if (std::find(encoded.begin(), encoded.end(), false) != encoded.end())
+		return false;
+	// Magic number, offsets of pages and terminating zero, all little endian.
+	// Table has the standard size, so pages can be appended in place later
+	std::vector<uint32_t> table(1 + std::max(COUNT + 1, TABLE_ENTRIES), 0);
+	table[0] = MAGIC;
+	size_t pos = 4 * table.size();
+	for (size_t i = 0; i < COUNT; ++i)
+	{
+		table[i + 1] = static_cast<uint32_t>(pos);
+		pos += encodedPages[i].size();
+	}
 	std::ofstream out(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
 	if (!out)
 		return false;
-	// 1. Write magic number (little endian)
-	uint32_t magic = 0x3ADE68B1;
-	out.write(reinterpret_cast<const char*>(&magic), 4);
-	// 2. Reserve space for offset table (N offsets + a terminating zero)
-	size_t count = pages.size();
-	std::vector<std::streampos> offsetPositions; // where offsets are written
-	offsetPositions.reserve(count);
-	const uint32_t ZERO = 0;
-	for (size_t i = 0; i < count + 1; ++i)
-	{
-		offsetPositions.push_back(out.tellp());  // remember where
-		out.write(reinterpret_cast<const char*>(&ZERO), 4);
-	}
-	// 3. Write PCX pages & record offsets
-	std::vector<uint32_t> realOffsets;
-	realOffsets.reserve(count);
-	std::streampos pos;
-	for (size_t i = 0; i < count; ++i)
-	{
-		pos = out.tellp();    // current file position
-		realOffsets.push_back(static_cast<uint32_t>(pos));
-		// write PCX data at this position
-		ImagePCX::savePCX(out, pages[i]);
-	}
-	// 4. Patch offsets in the table
-	for (size_t i = 0; i < count; ++i)
-	{
-		out.seekp(offsetPositions[i], std::ios::beg);
-		uint32_t v = realOffsets[i];
-		out.write(reinterpret_cast<const char*>(&v), 4);
-	}
-	// 5. Write terminating offset = 0 (already placeholder, but we ensure it)
-	out.seekp(offsetPositions[count], std::ios::beg);
-	out.write(reinterpret_cast<const char*>(&ZERO), 4);
+	out.write(reinterpret_cast<const char*>(table.data()), table.size() * 4);
+	for (const PixelBuffer& page : encodedPages)
+		out.write(reinterpret_cast<const char*>(page.data()), page.size());
+	if (!out)
+		return false;
+	if (options.source.empty() && filepath == sourcePath)
+	{
+		// Pages moved within the overwritten file, pages dropped from the cache are read from their new place.
+		// Saved pages are already cut and reduced, so they are read whole from now on
+		ImageDCX* self = const_cast<ImageDCX*>(this);
+		self->ranges.resize(COUNT);
+		for (size_t i = 0; i < COUNT; ++i)
+		{
+			self->ranges[i] = {table[i + 1], static_cast<uint32_t>(table[i + 1] + encodedPages[i].size())};
+			self->pageStates[i].pinned = false; // Added and edited pages are in the file now
+		}
+		self->options.region = ImageRegion();
+		self->options.downscale = 1;
+	}
 	return true;
 }
 
+bool ImageDCX::acceptLayout(ImageInfo&)
+{
+	return false; // Pages are added with addImage()
+}
+
+void ImageDCX::markModified()
+{
+	if (pageCheckedOut && selectedPage < pageStates.size())
+		pageStates[selectedPage].pinned = true; // Edits would be lost with the page
+}
+
 void ImageDCX::addImage(ImagePCX::PagePCX image)
 {
-	pages.emplace_back(image);
+	ensureDecoded();
+	// Keeps all pages in one resource, so selecting a page only moves its buffer
+	image.pixelData = PixelBuffer(std::move(image.pixelData), getMemoryResource());
+	PageState state;
+	state.decoded = true;
+	state.pinned = true;
+	state.bytes = image.pixelData.size();
+	state.lastUse = ++useCounter;
+	cachedBytes += state.bytes;
+	pages.emplace_back(std::move(image));
+	pageStates.push_back(state);
+	evictPages();
+}
+
+bool ImageDCX::appendPage(const std::string& filepath, const ImagePCX::PagePCX& page, ImageRange* written)
+{
+	PixelBuffer encoded;
+	if (!ImagePCX::encodePCX(page.header, page.pixelData, encoded))
+		return false;
+	std::fstream file(filepath, std::ios::in | std::ios::out | std::ios::binary);
+	if (!file.is_open())
+	{
+		// New archive with empty table
+		std::vector<uint32_t> table(1 + TABLE_ENTRIES, 0);
+		table[0] = MAGIC;
+		std::ofstream create(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+		create.write(reinterpret_cast<const char*>(table.data()), table.size() * 4);
+		if (!create)
+			return false;
+		create.close();
+		file.open(filepath, std::ios::in | std::ios::out | std::ios::binary);
+		if (!file.is_open())
+			return false;
+	}
+	file.seekg(0, std::ios::end);
+	const uint32_t FILE_SIZE = static_cast<uint32_t>(file.tellg());
+	file.seekg(0);
+	uint32_t magic = 0;
+	file.read(reinterpret_cast<char*>(&magic), 4);
+	if (!file || magic != MAGIC)
+		return false;
+	// First free entry, the table ends where the first page starts
+	size_t slot = 0;
+	uint32_t tableEnd = FILE_SIZE;
+	uint32_t offset = 0;
+	while (file.read(reinterpret_cast<char*>(&offset), 4) && offset != 0)
+	{
+		tableEnd = std::min(tableEnd, offset);
+		slot++;
+	}
+	// New entry and the terminator after it must fit before the first page
+	if (!file || 4 * (slot + 3) > tableEnd)
+		return false;
+	file.clear();
+	file.seekp(0, std::ios::end);
+	file.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+	// Page is complete before it is listed, so an interrupted append leaves a valid archive
+	if (!file.flush())
+		return false;
+	const uint32_t ENTRY[2] = {FILE_SIZE, 0};
+	file.seekp(4 * (slot + 1));
+	file.write(reinterpret_cast<const char*>(ENTRY), sizeof(ENTRY));
+	if (!file.flush())
+		return false;
+	if (written)
+		*written = {FILE_SIZE, static_cast<uint32_t>(FILE_SIZE + encoded.size())};
+	return true;
+}
+
+bool ImageDCX::appendImage(ImagePCX::PagePCX image)
+{
+	ensureDecoded();
+	ImageRange range;
+	if (!appendPage(filepath, image, &range))
+		return false;
+	if (pages.empty() && sourcePath.empty())
+		sourcePath = filepath; // Archive was created by the append
+	// Page can be decoded again from the file only when pages of this image come from it unchanged
+	const bool FROM_FILE = options.source.empty() && filepath == sourcePath && options.region.isEmpty() && options.downscale == 1;
+	addImage(std::move(image));
+	if (FROM_FILE)
+	{
+		ranges.resize(pages.size());
+		ranges.back() = range;
+		pageStates.back().pinned = false;
+		evictPages();
+	}
+	numOfPages = pages.size();
+	return true;
 }
 
 size_t ImageDCX::getSelectedPageIndex() const
@@ -174,22 +457,56 @@ size_t ImageDCX::getSelectedPageIndex() const
 
 void ImageDCX::selectPage(size_t index)
 {
-	if (index < pages.size())
+	ensureDecoded();
+	if (index >= pages.size())
+		return;
+	if (!decodePage(index))
 	{
-		selectedPage = index;
-		pixelData = pages[index].pixelData;
-		image = pages[index].image;
-		headerPCX = pages[index].header;
+		technical.technicalMessage = pages[index].msg;
+		return;
 	}
+	// Buffers only change owners, so switching pages costs the same for any page size.
+	// Page written through the image (pixels, views or scanlines) is pinned, so its edits aren't evicted
+	if (pageCheckedOut)
+		pages[selectedPage].pixelData = std::move(pixelData);
+	selectedPage = index;
+	pixelData = std::move(pages[index].pixelData);
+	pageCheckedOut = true;
+	image = pages[index].image;
+	headerPCX = pages[index].header;
+	evictPages(); // Previously selected page can go now
+}
+
+ImageDCX::SelectedPage ImageDCX::getSelectedPage() const
+{
+	ensureDecoded();
+	const ImagePCX::PagePCX& page = pages[selectedPage];
+	return {page.header, page.image, page.palette, page.msg, getPagePixels(selectedPage)};
+}
+
+const PixelBuffer& ImageDCX::getPagePixels(size_t index) const
+{
+	ensureDecoded();
+	if (pageCheckedOut && index == selectedPage)
+		return pixelData;
+	// Decoding is logically const, the same as ensureDecoded()
+	const_cast<ImageDCX*>(this)->decodePage(index);
+	return pages[index].pixelData;
+}
+
+bool ImageDCX::isPageDecoded(size_t index) const
+{
+	return index < pageStates.size() && pageStates[index].decoded;
 }
 
-const ImagePCX::PagePCX& ImageDCX::getSelectedPage() const
+size_t ImageDCX::getCachedBytes() const
 {
-	return pages[selectedPage];
+	return cachedBytes;
 }
 
 size_t ImageDCX::getPageCount() const
 {
+	ensureDecoded();
 	return pages.size();
 }
 
@@ -2,22 +2,64 @@
 // File       : ImageGIF.cpp
 // Author     : riyufuchi
 // Created on : Nov 06, 2025
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
 
 #include "../../consoleartlib/images/formats/image_gif.h"
 
-#include "../utils/stb_image.h"
-#include "../utils/stb_image_write.h"
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <optional>
+#include <sstream>
+
+#include "../../consoleartlib/images/image_factory.h"
+#include "../../consoleartlib/images/utils/parallel.hpp"
 
 namespace consoleartlib
 {
 
-ImageGIF::ImageGIF(const std::string& filepath) : Image(filepath, ImageType::GIF), selectedFrameIndex(0)
+static constexpr size_t FRAME_STORE_KEYFRAME_INTERVAL = 32; // Rebuilding a frame copies at most 31 rectangles
+
+ImageGIF::ImageGIF(const std::string& filepath, const LoadOptions& options) : Image(filepath, ImageType::GIF, options), selectedFrameIndex(0),
+	frameScratch(getMemoryResource())
 {
-	loadImage();
+	if (options.deferDecode)
+		deferDecode(probe(filepath, image, options.source));
+	else
+		loadImage();
+}
+
+/**
+ * Walks GIF blocks without decompressing them, just to count frames.
+ */
+TechnicalInfo ImageGIF::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	TechnicalInfo technical;
+	GIFDecoder decoder(filepath, source);
+	if (!decoder.isValid())
+	{
+		technical.technicalMessage = decoder.getFileStatus();
+		return technical;
+	}
+	const size_t FRAME_COUNT = decoder.scanFrames().size();
+	if (FRAME_COUNT == 0)
+	{
+		technical.technicalMessage = "GIF contains no frames";
+		return technical;
+	}
+	info.width = decoder.getWidth();
+	info.height = decoder.getHeight();
+	info.bits = 32;
+	info.channels = 4;
+	info.pixelByteOrder = PixelByteOrder::RGBA;
+	info.animated = FRAME_COUNT > 1;
+	info.multipage = FRAME_COUNT > 1;
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
 }
 
 ImageGIF::~ImageGIF()
@@ -26,96 +68,189 @@ ImageGIF::~ImageGIF()
 
 void ImageGIF::loadImage()
 {
-	int width = 0, height = 0, frameCount = 0, channels = 0;
-	int* delayArr = nullptr;
-	// Read file into memory
-	std::ifstream ifs(filepath, std::ios::binary | std::ios::ate);
-	if (!ifs)
+	decoder = std::make_unique<GIFDecoder>(filepath, options.source, options.threads);
+	if (!decoder->isValid())
 	{
-		technical.technicalMessage = "Failed to open file.";
+		technical.technicalMessage = decoder->getFileStatus();
 		return;
 	}
-	std::streamsize size = ifs.tellg();
-	ifs.seekg(0, std::ios::beg);
-	std::vector<unsigned char> buffer(size);
-	if (!ifs.read((char*)buffer.data(), size))
+	// Blocks are walked once for delays, frames are decoded when they are selected
+	const std::vector<GIFFrame> FRAMES = decoder->scanFrames();
+	if (FRAMES.empty())
 	{
-		technical.technicalMessage = "Failed to read file.";
+		technical.technicalMessage = "GIF contains no frames";
 		return;
 	}
-	unsigned char* data = stbi_load_gif_from_memory(buffer.data(), (int)buffer.size(), &delayArr, &width, &height, &frameCount, &channels, 4);
-
-	if (!data)
+	// Fill Image base info, frames keep only the region
+	const ImageRegion REGION = clipRegion(options.region, decoder->getWidth(), decoder->getHeight());
+	if (REGION.isEmpty())
 	{
-		technical.technicalMessage = stbi_failure_reason();
+		technical.technicalMessage = "Region lies outside of the image";
 		return;
 	}
-
-	const size_t frameSize = static_cast<size_t>(width) * height * 4;
-	frames.resize(frameCount);
-	delays.resize(frameCount);
-
-	for (int i = 0; i < frameCount; ++i)
-	{
-		frames[i].resize(frameSize);
-		std::memcpy(frames[i].data(), data + i * frameSize, frameSize);
-		delays[i] = delayArr ? delayArr[i] : 100;
-	}
-
-	// Fill Image base info
-	image.width = width;
-	image.height = height;
+	image.width = reducedSize(REGION.width, options.downscale);
+	image.height = reducedSize(REGION.height, options.downscale);
 	image.bits = 32;
 	image.channels = 4;
 	image.pixelByteOrder = PixelByteOrder::RGBA;
+	frames = std::make_unique<FrameStore>(image.width, image.height, 4, getRowStride(), FRAME_STORE_KEYFRAME_INTERVAL, getMemoryResource());
+	delays.clear();
+	for (const GIFFrame& frame : FRAMES)
+		delays.push_back(frame.delay);
+	selectedFrameIndex = 0;
+	if (!composeFrame(0, pixelData))
+	{
+		technical.technicalMessage = "Unable to decode first frame";
+		return;
+	}
 	technical.fileState = FileState::VALID_IMAGE_FILE;
 	technical.technicalMessage = "GIF loaded successfully";
-	if (frameCount > 1)
+	if (FRAMES.size() > 1)
 	{
 		image.animated = true;
 		image.multipage = true;
 	}
+}
 
-	// Keep first frame as default pixelData
-	pixelData = frames[0];
+/**
+ * Rebuilds frame from the store, frames not decoded yet are decoded in order up to index and stored.
+ */
+bool ImageGIF::composeFrame(size_t index, PixelBuffer& target)
+{
+	if (frames->getFrame(index, target))
+		return true;
+	// Decoder stays on the last stored frame, so it only goes forward
+	const size_t MISSING = index + 1 - frames->getFrameCount();
+	const size_t COMPOSED = decoder->nextFrames(MISSING, [&](const GIFDecoder& source)
+	{
+		exportCanvas(source, target);
+		frames->addFrame(target.data());
+	});
+	return COMPOSED == MISSING;
+}
 
-	stbi_image_free(data);
-	if (delayArr)
-		free(delayArr); // stb allocates it with malloc
+/**
+ * Copies region (reduced when downscaling) of the composed canvas into target.
+ */
+void ImageGIF::exportCanvas(const GIFDecoder& source, PixelBuffer& target) const
+{
+	const ImageRegion REGION = clipRegion(options.region, source.getWidth(), source.getHeight());
+	const size_t FULL_ROW_SIZE = static_cast<size_t>(source.getWidth()) * 4;
+	const size_t ROW_SIZE = static_cast<size_t>(image.width) * 4;
+	const size_t STRIDE = getRowStride();
+	const uint8_t* first = source.getCanvas().data() + REGION.y * FULL_ROW_SIZE + REGION.x * 4;
+	target.resize(STRIDE * image.height);
+	if (options.downscale > 1)
+		BoxFilter<uint8_t>(REGION.width, 4, options.downscale).reduce(first, REGION.height, FULL_ROW_SIZE, target.data(), STRIDE);
+	else if (STRIDE == FULL_ROW_SIZE)
+		std::memcpy(target.data(), first, STRIDE * REGION.height);
+	else
+		for (int y = 0; y < REGION.height; y++)
+			std::memcpy(target.data() + y * STRIDE, first + y * FULL_ROW_SIZE, ROW_SIZE);
 }
 
 consoleartlib::Pixel ImageGIF::getPixel(int x, int y) const
 {
-	x = (y * image.width + x) * image.channels;
+	ensureDecoded();
+	x = y * getRowStride() + x * image.channels;
 	return {pixelData[x], pixelData[x + 1], pixelData[x + 2], pixelData[x + 3]};
 }
 
 void ImageGIF::setPixel(int x, int y, consoleartlib::Pixel pixel)
 {
-	x = (y * image.width + x) * image.channels;
+	ensureDecoded();
+	x = y * getRowStride() + x * image.channels;
 	pixelData[x] = pixel.red;
 	pixelData[x + 1] = pixel.green;
 	pixelData[x + 2] = pixel.blue;
 	pixelData[x + 3] = pixel.alpha;
 }
 
+bool ImageGIF::acceptLayout(ImageInfo&)
+{
+	return false; // Frames can't be adopted one by one
+}
+
 bool ImageGIF::saveImage() const
 {
-	return false;
+	return saveAnimation(false);
 }
 
-const std::vector<uint8_t>& ImageGIF::getFrame(int index) const
+bool ImageGIF::saveAnimation(bool globalPalette) const
 {
-	return frames[index];
+	ensureDecoded();
+	if (delays.empty())
+		return false;
+	// All frames get into the store before the file is opened, as the decoder may still read from it
+	if (getFrame(static_cast<int>(delays.size() - 1)).empty())
+		return false;
+	const size_t STRIDE = getRowStride();
+	std::optional<ColorQuantizer> colors;
+	if (globalPalette)
+	{
+		// Every worker counts colors of its own run of frames rebuilt from the store, counts are merged afterwards
+		const size_t COUNT = delays.size();
+		const unsigned WORKERS = workerCount(options.threads, COUNT);
+		std::vector<ColorQuantizer> parts(WORKERS, ColorQuantizer(255));
+		parallelFor(WORKERS, [&](size_t part)
+		{
+			PixelBuffer scratch;
+			for (size_t index = part * COUNT / WORKERS; index < (part + 1) * COUNT / WORKERS; index++)
+			{
+				const PixelBuffer* frame = &pixelData;
+				if (index != selectedFrameIndex)
+				{
+					if (!frames->getFrame(index, scratch))
+						continue;
+					frame = &scratch;
+				}
+				for (int y = 0; y < image.height; y++)
+					parts[part].addPixels(frame->data() + y * STRIDE, image.width);
+			}
+		}, WORKERS);
+		colors.emplace(std::move(parts[0]));
+		for (size_t part = 1; part < parts.size(); part++)
+			colors->merge(parts[part]);
+		colors->buildPalette();
+	}
+	std::ofstream file(filepath, std::ios::binary);
+	if (!file)
+		return false;
+	GIFEncoder encoder(file, image.width, image.height, options.threads, colors ? &*colors : nullptr);
+	for (size_t index = 0; index < delays.size(); index++)
+	{
+		const PixelBuffer& frame = getFrame(static_cast<int>(index));
+		if (frame.empty() || !encoder.addFrame(frame.data(), STRIDE, delays[index]))
+			return false;
+	}
+	return encoder.finish();
+}
+
+const PixelBuffer& ImageGIF::getFrame(int index) const
+{
+	ensureDecoded();
+	if (static_cast<size_t>(index) == selectedFrameIndex)
+		return pixelData;
+	// Decoding is logically const, the same as ensureDecoded()
+	ImageGIF* self = const_cast<ImageGIF*>(this);
+	if (index < 0 || static_cast<size_t>(index) >= delays.size() || !self->composeFrame(index, self->frameScratch))
+		self->frameScratch.clear();
+	return frameScratch;
 }
 
 void ImageGIF::selectPage(size_t index)
 {
-	if (index < frames.size())
+	ensureDecoded();
+	if (index >= delays.size() || index == selectedFrameIndex)
+		return;
+	// Frame is composed aside, so a frame that fails to decode leaves the selected one as it was
+	if (!composeFrame(index, frameScratch))
 	{
-		pixelData = frames[index];
-		selectedFrameIndex = index;
+		technical.technicalMessage = "Unable to decode frame " + std::to_string(index);
+		return;
 	}
+	std::swap(pixelData, frameScratch);
+	selectedFrameIndex = index;
 }
 
 size_t ImageGIF::getSelectedPageIndex() const
@@ -125,25 +260,96 @@ size_t ImageGIF::getSelectedPageIndex() const
 
 int ImageGIF::getFrameDelay(size_t index) const
 {
+	ensureDecoded();
 	return delays[index];
 }
 
-bool ImageGIF::spitIntoPNGs() const
+static std::string extensionOf(ImageType type)
+{
+	switch (type)
+	{
+		case ImageType::BMP: return ".bmp";
+		case ImageType::PCX: return ".pcx";
+		case ImageType::PPM: return ".ppm";
+		case ImageType::PNG: return ".png";
+		case ImageType::TGA: return ".tga";
+		default: return "";
+	}
+}
+
+/**
+ * Encodes one frame through band writer of the format, into target or into the file when target is nullptr.
+ * Reads only the store and the selected frame, so frames can be exported in parallel.
+ */
+TechnicalInfo ImageGIF::exportFrame(size_t index, const std::string& filepath, ImageType type, std::ostream* target) const
 {
-	int index = 0;
-	std::string name = getFilename();
-	name.replace(name.length() - 4, name.length(), ".png");
-	for (const std::vector<uint8_t>& pixelData : frames)
+	PixelBuffer scratch;
+	const PixelBuffer* pixels = &pixelData;
+	if (index != selectedFrameIndex)
 	{
-		stbi_write_png((std::to_string(index) + "-" + name).c_str(), image.width, image.height, image.channels, pixelData.data(), image.width * image.channels);
-		index++;
+		if (!frames->getFrame(index, scratch))
+			return {"Unable to decode frame " + std::to_string(index), FileState::INVALID_IMAGE_FILE};
+		pixels = &scratch;
 	}
-	return true;
+	std::unique_ptr<BandWriter> writer = image_factory::createBandWriter(filepath, type, image.width, image.height, image.channels, target);
+	if (!writer)
+		return {"Frames can't be exported in this format", FileState::INVALID_IMAGE_FILE};
+	if (!writer->writeBand(ConstImageView(pixels->data(), image.width, image.height, getScanlineFormat())) || !writer->finish())
+		return {writer->getFileStatus(), FileState::INVALID_IMAGE_FILE};
+	return {writer->getFileStatus(), FileState::VALID_IMAGE_FILE};
+}
+
+/**
+ * Decodes all frames into the store first, then runs task for every frame on the workers.
+ */
+std::vector<TechnicalInfo> ImageGIF::exportFrames(ImageType type, unsigned threads, const std::function<TechnicalInfo(size_t)>& task) const
+{
+	ensureDecoded();
+	std::vector<TechnicalInfo> statuses(delays.size());
+	if (delays.empty())
+		return statuses;
+	if (extensionOf(type).empty())
+	{
+		for (TechnicalInfo& status : statuses)
+			status.technicalMessage = "Frames can't be exported in this format";
+		return statuses;
+	}
+	getFrame(static_cast<int>(delays.size() - 1)); // Frames that fail to decode get their status from exportFrame()
+	parallelFor(delays.size(), [&](size_t index) { statuses[index] = task(index); }, threads);
+	return statuses;
+}
+
+std::vector<TechnicalInfo> ImageGIF::exportFrames(const std::string& directory, ImageType type, unsigned threads) const
+{
+	const std::string STEM = std::filesystem::path(getFilename()).stem().string();
+	return exportFrames(type, threads, [&](size_t index)
+	{
+		const std::filesystem::path PATH = std::filesystem::path(directory) / (std::to_string(index) + "-" + STEM + extensionOf(type));
+		return exportFrame(index, PATH.string(), type, nullptr);
+	});
+}
+
+std::vector<TechnicalInfo> ImageGIF::exportFrames(ImageType type, const FrameSink& sink, unsigned threads) const
+{
+	std::mutex sinkMutex;
+	return exportFrames(type, threads, [&](size_t index)
+	{
+		std::ostringstream encoded;
+		TechnicalInfo status = exportFrame(index, std::to_string(index) + extensionOf(type), type, &encoded);
+		if (status.fileState == FileState::VALID_IMAGE_FILE)
+		{
+			const std::string DATA = encoded.str();
+			std::lock_guard<std::mutex> lock(sinkMutex);
+			sink(index, DATA);
+		}
+		return status;
+	});
 }
 
 size_t ImageGIF::getPageCount() const
 {
-	return frames.size();
+	ensureDecoded();
+	return delays.size();
 }
 
 } /* namespace sdl */
@@ -2,7 +2,7 @@
 // File       : ImageHDR.cpp
 // Author     : riyufuchi
 // Created on : Nov 07, 2025
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -14,51 +14,65 @@
 namespace consoleartlib
 {
 
-ImageHDR::ImageHDR(const std::string& filename, bool convert) : Image(filename, ImageType::HDR)
+ImageHDR::ImageHDR(const std::string& filename, bool convert, const LoadOptions& options) : Image(filename, ImageType::HDR, options), pixelDataHDR(getMemoryResource()), convertOnLoad(convert)
 {
-	loadImage();
-	if (convert && isLoaded())
-		convertTo8bit();
+	this->options.rowAlignment = 0; // Float rows stay packed, only the buffers stay aligned
+	if (options.deferDecode)
+		deferDecode(probe(filepath, image, options.source));
+	else
+		loadImage();
 }
 
 ImageHDR::~ImageHDR()
 {
 }
 
+/**
+ * Reads only the header through stb.
+ */
+TechnicalInfo ImageHDR::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	TechnicalInfo technical;
+	const int OK = source.empty() ? stbi_info(filepath.c_str(), &info.width, &info.height, &info.channels)
+		: stbi_info_from_memory(source.data(), static_cast<int>(source.size()), &info.width, &info.height, &info.channels);
+	if (!OK)
+	{
+		technical.technicalMessage = stbi_failure_reason();
+		return technical;
+	}
+	info.bits = info.channels * 8;
+	info.hdr = true;
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
+}
+
 PixelHDR ImageHDR::getPixelHDR(int x, int y) const
 {
+	ensureDecoded();
 	if (x < 0 || y < 0 || x >= image.width || y >= image.height)
 		return {};
 
-	x = (y * image.width + x) * image.channels;
-
-	return {
-		pixelDataHDR[x],
-		pixelDataHDR[x + 1],
-		(image.channels > 2) ? pixelDataHDR[x + 2] : 0.0f,
-		(image.channels > 3) ? pixelDataHDR[x + 3] : 1.0f
-	};
+	const float* data = pixelDataHDR.data() + (y * image.width + x) * image.channels;
+	return pixel_formats::dispatchHDR(image.channels, [data](const auto format) { return format.load(data); });
 }
 
 void ImageHDR::setPixelHDR(int x, int y, PixelHDR newPixel)
 {
+	ensureDecoded();
 	if (x < 0 || y < 0 || x >= image.width || y >= image.height)
 		return;
 
-	x = (y * image.width + x) * image.channels;
-
-	pixelDataHDR[x] = newPixel.red;
-	pixelDataHDR[x + 1] = newPixel.green;
-	if (image.channels > 2)
-		pixelDataHDR[x + 2] = newPixel.blue;
-	if (image.channels > 3)
-		pixelDataHDR[x + 3] = newPixel.alpha;
+	float* data = pixelDataHDR.data() + (y * image.width + x) * image.channels;
+	pixel_formats::dispatchHDR(image.channels, [data, &newPixel](const auto format) { format.store(data, newPixel); });
 }
 
 void ImageHDR::convertTo8bit()
 {
+	ensureDecoded();
 	if (pixelDataHDR.empty())
 		return;
+	pixelData.clear();
 	pixelData.reserve(pixelDataHDR.size());
 	constexpr float gamma = 1.0f / 2.0f; // sRGB gamma correction
 	for (float v : pixelDataHDR)
@@ -70,8 +84,10 @@ void ImageHDR::convertTo8bit()
 
 void ImageHDR::convertFrom8bit()
 {
+	ensureDecoded();
 	if (pixelData.empty())
 		return;
+	pixelDataHDR.clear();
 	pixelDataHDR.reserve(pixelData.size());
 	for (uint8_t v : pixelData)
 		pixelDataHDR.push_back(v / 255.0f);
@@ -79,6 +95,7 @@ void ImageHDR::convertFrom8bit()
 
 consoleartlib::Pixel ImageHDR::getPixel(int x, int y) const
 {
+	ensureDecoded();
 	if (x < 0 || y < 0 || x >= image.width || y >= image.height)
 		return {};
 
@@ -94,6 +111,7 @@ consoleartlib::Pixel ImageHDR::getPixel(int x, int y) const
 
 void ImageHDR::setPixel(int x, int y, consoleartlib::Pixel newPixel)
 {
+	ensureDecoded();
 	if (x < 0 || y < 0 || x >= image.width || y >= image.height)
 		return;
 
@@ -107,28 +125,61 @@ void ImageHDR::setPixel(int x, int y, consoleartlib::Pixel newPixel)
 		pixelData[x + 3] = newPixel.alpha;
 }
 
+bool ImageHDR::acceptLayout(ImageInfo& layout)
+{
+	Image::acceptLayout(layout);
+	layout.hdr = true;
+	pixelDataHDR.clear(); // Rebuilt from 8-bit data on save
+	return true;
+}
+
 bool ImageHDR::saveImage() const
 {
-	if (pixelDataHDR.empty())
+	ensureDecoded();
+	if (!pixelDataHDR.empty())
+		return stbi_write_hdr(filepath.c_str(), image.width, image.height, image.channels, pixelDataHDR.data()) != 0;
+	if (pixelData.empty())
 		return false;
-	return stbi_write_hdr(filepath.c_str(), image.width, image.height, image.channels, pixelDataHDR.data()) != 0;
+	std::vector<float> converted(pixelData.size());
+	for (size_t i = 0; i < pixelData.size(); i++)
+		converted[i] = pixelData[i] / 255.0f;
+	return stbi_write_hdr(filepath.c_str(), image.width, image.height, image.channels, converted.data()) != 0;
 }
 
 void ImageHDR::loadImage()
 {
-	float* imageDataHDR = stbi_loadf(filepath.c_str(), &image.width, &image.height, &image.channels, 0);
+	float* imageDataHDR = options.source.empty() ? stbi_loadf(filepath.c_str(), &image.width, &image.height, &image.channels, 0)
+		: stbi_loadf_from_memory(options.source.data(), static_cast<int>(options.source.size()), &image.width, &image.height, &image.channels, 0);
 	if (!imageDataHDR)
 	{
 		technical.technicalMessage = "Image loading failed.";
 	}
 	else
 	{
+		// stb decodes whole image, only the region is kept (reduced when downscaling)
+		const ImageRegion REGION = clipRegion(options.region, image.width, image.height);
+		const size_t FULL_ROW_SIZE = static_cast<size_t>(image.width) * image.channels;
+		const float* first = imageDataHDR + REGION.y * FULL_ROW_SIZE + REGION.x * image.channels;
+		image.width = reducedSize(REGION.width, options.downscale);
+		image.height = reducedSize(REGION.height, options.downscale);
 		image.bits = image.channels * 8;
 		image.hdr = true;
-		pixelDataHDR.resize(image.width * image.height * image.channels); // Resize the class vector to hold image data
-		std::memcpy(pixelDataHDR.data(), imageDataHDR, pixelDataHDR.size() * sizeof(float)); // Copy the raw bytes
+		const size_t ROW_SIZE = static_cast<size_t>(image.width) * image.channels;
+		pixelDataHDR.resize(ROW_SIZE * image.height); // Resize the class vector to hold image data
+		if (options.downscale > 1)
+			BoxFilter<float>(REGION.width, image.channels, options.downscale).reduce(first, REGION.height, FULL_ROW_SIZE, pixelDataHDR.data(), ROW_SIZE);
+		else
+			for (int y = 0; y < REGION.height; y++) // Copy the raw bytes
+				std::memcpy(pixelDataHDR.data() + y * ROW_SIZE, first + y * FULL_ROW_SIZE, ROW_SIZE * sizeof(float));
 		stbi_image_free(imageDataHDR); // Always free the original STB data
+		if (REGION.isEmpty())
+		{
+			technical.technicalMessage = "Region lies outside of the image";
+			return;
+		}
 		technical.fileState = FileState::VALID_IMAGE_FILE;
+		if (convertOnLoad)
+			convertTo8bit();
 	}
 }
 
@@ -2,7 +2,7 @@
 // File       : ImageJPG.cpp
 // Author     : riyufuchi
 // Created on : Feb 28, 2025
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -13,9 +13,12 @@
 
 namespace consoleartlib
 {
-ImageJPG::ImageJPG(const std::string& filepath) : Image(filepath, ImageType::JPG)
+ImageJPG::ImageJPG(const std::string& filepath, const LoadOptions& options) : Image(filepath, ImageType::JPG, options)
 {
-	loadImage();
+	if (options.deferDecode)
+		deferDecode(probe(filepath, image, options.source));
+	else
+		loadImage();
 }
 
 ImageJPG::ImageJPG(const std::string& filepath, int width, int height, int channels) : Image(filepath, ImageType::JPG)
@@ -24,7 +27,7 @@ ImageJPG::ImageJPG(const std::string& filepath, int width, int height, int chann
 	image.height = height;
 	image.channels = channels;
 	image.bits = image.channels * 8;
-	pixelData.resize(width * height * channels);
+	pixelData.resize(getRowStride() * height);
 	technical.fileState =  FileState::VALID_IMAGE_FILE;
 }
 
@@ -32,19 +35,40 @@ ImageJPG::~ImageJPG()
 {
 }
 
+/**
+ * Reads only the header through stb.
+ */
+TechnicalInfo ImageJPG::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	TechnicalInfo technical;
+	const int OK = source.empty() ? stbi_info(filepath.c_str(), &info.width, &info.height, &info.channels)
+		: stbi_info_from_memory(source.data(), static_cast<int>(source.size()), &info.width, &info.height, &info.channels);
+	if (!OK)
+	{
+		technical.technicalMessage = stbi_failure_reason();
+		return technical;
+	}
+	info.bits = info.channels * 8;
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
+}
+
 consoleartlib::Pixel ImageJPG::getPixel(int x, int y) const
 {
+	ensureDecoded();
 	if (x < 0 || y < 0 || x >= image.width || y >= image.height)
 		return {0, 0, 0, 255};
-	x = (y * image.width + x) * image.channels;
+	x = y * getRowStride() + x * image.channels;
 	return {pixelData[x], pixelData[x + 1], pixelData[x + 2], (image.channels == 4 ? pixelData[x + 3] : (uint8_t)255)};
 }
 
 void ImageJPG::setPixel(int x, int y, consoleartlib::Pixel newPixel)
 {
+	ensureDecoded();
 	if (x < 0 || y < 0 || x >= image.width || y >= image.height)
 		return;
-	x = (y * image.width + x) * image.channels;
+	x = y * getRowStride() + x * image.channels;
 	pixelData[x] = newPixel.red;
 	pixelData[x + 1] = newPixel.green;
 	pixelData[x + 2] = newPixel.blue;
@@ -54,23 +78,34 @@ void ImageJPG::setPixel(int x, int y, consoleartlib::Pixel newPixel)
 
 bool ImageJPG::saveImage() const
 {
-	return stbi_write_jpg(filepath.c_str(), image.width, image.height, image.channels, pixelData.data(), 100) != 0;
+	ensureDecoded();
+	PixelBuffer packed;
+	return stbi_write_jpg(filepath.c_str(), image.width, image.height, image.channels, exportRows(packed), 100) != 0;
 }
 
 void ImageJPG::loadImage()
 {
-	unsigned char* imageData = stbi_load(filepath.c_str(), &image.width, &image.height, &image.channels, 0);
+	unsigned char* imageData = options.source.empty() ? stbi_load(filepath.c_str(), &image.width, &image.height, &image.channels, 0)
+		: stbi_load_from_memory(options.source.data(), static_cast<int>(options.source.size()), &image.width, &image.height, &image.channels, 0);
 	if (!imageData)
 	{
 		technical.technicalMessage = "Image loading failed.";
 	}
 	else
 	{
+		// stb decodes whole image, only the region is kept (reduced when downscaling)
+		const ImageRegion REGION = clipRegion(options.region, image.width, image.height);
+		const int FULL_WIDTH = image.width;
+		image.width = reducedSize(REGION.width, options.downscale);
+		image.height = reducedSize(REGION.height, options.downscale);
 		image.bits = image.channels * 8;
-		pixelData.resize(image.width * image.height * image.channels); // Resize the class vector to hold image data
-		std::memcpy(pixelData.data(), imageData, pixelData.size()); // Copy the raw bytes
+		if (!REGION.isEmpty())
+			importRegion(imageData, FULL_WIDTH, REGION); // Copy the raw bytes
 		stbi_image_free(imageData); // Always free the original STB data
-		technical.fileState =  FileState::VALID_IMAGE_FILE;
+		if (REGION.isEmpty())
+			technical.technicalMessage = "Region lies outside of the image";
+		else
+			technical.fileState =  FileState::VALID_IMAGE_FILE;
 	}
 }
 }
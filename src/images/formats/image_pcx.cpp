@@ -2,7 +2,7 @@
 // File       : ImagePCX.cpp
 // Author     : riyufuchi
 // Created on : Nov 22, 2023
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) Riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -11,37 +11,76 @@
 
 namespace consoleartlib
 {
-ImagePCX::ImagePCX(const std::string& filename) : Image(filename, ImageType::PCX)
+ImagePCX::ImagePCX(const std::string& filename, const LoadOptions& options) : Image(filename, ImageType::PCX, options)
 {
-	this->paletteVGA = nullptr;
 	this->image.planar = true;
-	loadImage();
-	this->BLUE_OFFSET = 2 * headerPCX.bytesPerLine;
-	this->ALPHA_OFFSET = 3 * headerPCX.bytesPerLine;
+	this->options.rowAlignment = 0; // Planes keep the file layout, only the buffer stays aligned
+	this->BLUE_OFFSET = 0;
+	this->ALPHA_OFFSET = 0;
+	if (options.deferDecode)
+		deferDecode(probe(filepath, image, options.source));
+	else
+		loadImage();
 }
-
-ImagePCX::~ImagePCX()
+/**
+ * Reads only the 128 byte header. Info describes image as it will be after decoding,
+ * so VGA images are reported as 24-bit with palette.
+ */
+TechnicalInfo ImagePCX::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	TechnicalInfo technical;
+	SourceStream stream(filepath, source);
+	if (!stream)
+	{
+		technical.technicalMessage = "Unable to open file: " + filepath;
+		return technical;
+	}
+	HeaderPCX header;
+	readHeader(stream, header, info);
+	try
+	{
+		if (!stream)
+			throw std::runtime_error("Incomplete header");
+		checkHeader(header, info);
+	}
+	catch (std::runtime_error& e)
+	{
+		technical.technicalMessage = e.what();
+		return technical;
+	}
+	probeHeader(header, info);
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
+}
+void ImagePCX::probeHeader(const HeaderPCX& headerPCX, ImageInfo& info)
 {
-	if (paletteVGA)
+	info.planar = true;
+	if (isVGA(headerPCX))
 	{
-		delete[] paletteVGA;
-		paletteVGA = nullptr;
+		info.palette = true;
+		info.channels = 3;
+		info.bits = 24;
 	}
 }
-bool ImagePCX::readVGA(std::ifstream& stream, PagePCX& pcx, const uint32_t end)
+
+ImagePCX::~ImagePCX()
+{
+}
+bool ImagePCX::readVGA(std::istream& stream, PagePCX& pcx, const uint32_t end)
 {
 	char VGAPaletteMarker;
 	stream.seekg(end - 769);
 	stream.read(&VGAPaletteMarker, 1);
 	if (VGAPaletteMarker != 0x0c || stream.fail())
 		return false;
-	pcx.palette = new PixelRGB[256];
+	pcx.palette.resize(256);
 	for (int entry = 0; entry < 256; entry++)
 		stream.read(reinterpret_cast<char*>(&pcx.palette[entry]), 3);
 	return !(stream.fail());
 }
 
-uint32_t ImagePCX::calcFileEnd(std::ifstream& stream)
+uint32_t ImagePCX::calcFileEnd(std::istream& stream)
 {
 	// Save current read position
 	std::streampos current = stream.tellg();
@@ -53,164 +92,254 @@ uint32_t ImagePCX::calcFileEnd(std::ifstream& stream)
 	return end;
 }
 
-void ImagePCX::readHeader(std::ifstream& stream, HeaderPCX& headerPCX, ImageInfo& image)
+void ImagePCX::readHeader(std::istream& stream, HeaderPCX& headerPCX, ImageInfo& image)
 {
 	stream.read(reinterpret_cast<char*>(&headerPCX), sizeof(headerPCX));
 	image.width = (headerPCX.xMax - headerPCX.xMin) + 1;;
 	image.height = (headerPCX.yMax - headerPCX.yMin) + 1;
 	image.file_type = headerPCX.file_type;
+	image.channels = headerPCX.numOfColorPlanes;
 	image.bits = headerPCX.numOfColorPlanes * 8;
 }
-bool ImagePCX::loadImageDataVGA(std::ifstream& stream, std::vector<uint8_t>& imageData, PagePCX& pcx, const uint32_t start, const uint32_t end)
+bool ImagePCX::readPCX(std::istream& stream, PagePCX& pcx, const uint32_t start, const uint32_t end, const ImageRegion& region, int downscale)
 {
-	if (!isVGA(pcx.header) || !readVGA(stream, pcx, end))
+	readHeader(stream, pcx.header, pcx.image);
+	try
 	{
-		pcx.msg = "Error during palete loading";
+		checkHeader(pcx.header, pcx.image);
+	}
+	catch (std::runtime_error& e)
+	{
+		pcx.msg = e.what();
 		return false;
 	}
-	stream.seekg(start + sizeof(HeaderPCX)); // Move back to start of image data
-	if (pcx.header.encoding == 1)
+	const ImageRegion REGION = clipRegion(region, pcx.image.width, pcx.image.height);
+	if (REGION.isEmpty())
 	{
-		decodeRLE(stream, imageData, pcx.header, end);
+		pcx.msg = "Region lies outside of the image";
+		return false;
 	}
-	else
+	if (pcx.header.bytesPerLine < pcx.image.width)
 	{
-		imageData.resize((pcx.image.width * pcx.image.height));
-		stream.read(reinterpret_cast<char*>(imageData.data()), imageData.size());
+		pcx.msg = "Scanline is shorter than image width";
+		return false;
 	}
-	return true;
-}
-bool ImagePCX::convertImageDataVGA(const std::vector<uint8_t>& imageData, PagePCX& pcx)
-{
-	pcx.pixelData.resize(pcx.image.width * pcx.image.height * 3);
-	pcx.header.numOfColorPlanes = 3;
-	pcx.image.bits = 24;
-	pcx.image.planar = true;
-	int i = 0;
-	int x, index;
-	PixelRGB pRGB;
-	for (int y = 0; y < pcx.image.height; y++)
+	const bool VGA = pcx.header.numOfColorPlanes == 1;
+	if (VGA)
 	{
-		for (x = 0; x < pcx.image.width; x++)
+		if (!readVGA(stream, pcx, end))
 		{
-			pRGB = pcx.palette[imageData[i]];
-			index = y * 3 * pcx.image.width + x;
-			pcx.pixelData[index] = pRGB.red;
-			pcx.pixelData[index + pcx.image.width]= pRGB.green;
-			pcx.pixelData[index + 2 * pcx.image.width] = pRGB.blue;
-			i++;
+			pcx.msg = "Error during palete loading";
+			return false;
 		}
+		stream.seekg(start + sizeof(HeaderPCX)); // Move back to start of image data
+		pcx.image.palette = true;
 	}
-	return true;
-}
-bool ImagePCX::readPCX(std::ifstream& stream, PagePCX& pcx, const uint32_t start, const uint32_t end)
-{
-	readHeader(stream, pcx.header, pcx.image);
-	try
+	else if (pcx.header.encoding == 0)
 	{
-		checkHeader(pcx.header, pcx.image);
+		pcx.msg = "Uncompressed image data are not supported for 24 and 32 bit images";
+		return false;
 	}
-	catch (std::runtime_error& e)
+	const uint32_t LENGHT = end - start - sizeof(HeaderPCX);
+	if (downscale > 1)
+		return readReducedPCX(stream, pcx, LENGHT, REGION, downscale);
+	if (!VGA && REGION.width == pcx.image.width && REGION.height == pcx.image.height)
 	{
-		pcx.msg = e.what();
+		// File layout is the final layout, planes are decoded straight into the page
+		if (!decodeRLE(stream, pcx.pixelData, pcx.header, LENGHT, pcx.image.height))
+		{
+			pcx.msg = "Unexpected end of pixel data";
+			return false;
+		}
+		return true;
+	}
+	// Scanlines of the region are cut (and VGA indexes expanded) straight into the final planes
+	const int PLANES = VGA ? 3 : pcx.header.numOfColorPlanes;
+	const size_t LINE = pcx.header.bytesPerLine;
+	const size_t NEW_LINE = (REGION.width == pcx.image.width) ? LINE : REGION.width + (REGION.width & 1);
+	pcx.pixelData.assign(NEW_LINE * PLANES * REGION.height, 0);
+	const PaletteLUT LUT(pcx.palette);
+	const bool COMPLETE = decodeScanlines(stream, pcx.header, LENGHT, REGION.y, REGION.height, [&](const uint8_t* scanline, int y)
+	{
+		uint8_t* row = pcx.pixelData.data() + y * NEW_LINE * PLANES;
+		if (VGA)
+		{
+			LUT.expandPlanar(scanline + REGION.x, REGION.width, row, row + NEW_LINE, row + 2 * NEW_LINE);
+			return;
+		}
+		for (int plane = 0; plane < PLANES; plane++)
+			std::memcpy(row + plane * NEW_LINE, scanline + plane * LINE + REGION.x, REGION.width);
+	});
+	if (!COMPLETE)
+	{
+		pcx.msg = "Unexpected end of pixel data";
 		return false;
 	}
-	bool success = true;
-	std::vector<uint8_t> imageData;
-	switch (pcx.header.numOfColorPlanes)
+	setPageLayout(pcx, PLANES, REGION.width, REGION.height, NEW_LINE);
+	return true;
+}
+/**
+ * Rewrites page header and info after the page was decoded into different layout than the file has.
+ */
+void ImagePCX::setPageLayout(PagePCX& pcx, int planes, int width, int height, size_t bytesPerLine)
+{
+	pcx.header.numOfColorPlanes = planes;
+	pcx.header.xMin = 0;
+	pcx.header.yMin = 0;
+	pcx.header.xMax = width - 1;
+	pcx.header.yMax = height - 1;
+	pcx.header.bytesPerLine = bytesPerLine;
+	pcx.image.width = width;
+	pcx.image.height = height;
+	pcx.image.channels = planes;
+	pcx.image.bits = planes * 8;
+	pcx.image.planar = true;
+}
+/**
+ * Decodes page scanline by scanline, every scanline (all planes) is box averaged as soon as it is complete,
+ * so only the reduced page is ever allocated. VGA indexes are expanded before averaging.
+ */
+bool ImagePCX::readReducedPCX(std::istream& stream, PagePCX& pcx, const uint32_t lenght, const ImageRegion& region, int factor)
+{
+	const bool VGA = pcx.header.numOfColorPlanes == 1;
+	const int PLANES = VGA ? 3 : pcx.header.numOfColorPlanes;
+	const size_t LINE = pcx.header.bytesPerLine;
+	const int WIDTH = reducedSize(region.width, factor);
+	const int HEIGHT = reducedSize(region.height, factor);
+	const size_t NEW_LINE = WIDTH + (WIDTH & 1);
+	pcx.pixelData.assign(NEW_LINE * PLANES * HEIGHT, 0);
+	BoxFilter<uint8_t> filter(region.width, PLANES, factor);
+	std::vector<uint8_t> rgb(VGA ? region.width * 3 : 0);
+	const PaletteLUT LUT(pcx.palette);
+	const bool COMPLETE = decodeScanlines(stream, pcx.header, lenght, region.y, region.height, [&](const uint8_t* scanline, int y)
 	{
-		case 1:
-			pcx.image.palette = true;
-			if (loadImageDataVGA(stream, imageData, pcx, start, end))
-				success = convertImageDataVGA(imageData, pcx);
-			else
-				success = false;
-			break;
-		case 3:
-		case 4:
-			if (pcx.header.encoding == 0)
-			{
-				pcx.msg = "Uncompressed image data are not supported for 24 and 32 bit images";
-				success = false;
-			}
-			else
-			{
-				//stream.seekg(start + sizeof(HeaderPCX));
-				decodeRLE(stream, pcx.pixelData, pcx.header, end - start);
-			}
-			break;
-		default:
-			pcx.msg = "Unexpected number of color planes";
-			return false;
+		if (VGA)
+		{
+			LUT.expandInterleaved(scanline + region.x, region.width, rgb.data(), 3);
+			filter.addRow(rgb.data());
+		}
+		else
+		{
+			filter.addRow(scanline + region.x, 1, LINE);
+		}
+		if ((y + 1) % factor == 0 || y == region.height - 1)
+			filter.flushRow(pcx.pixelData.data() + y / factor * NEW_LINE * PLANES, 1, NEW_LINE);
+	});
+	if (!COMPLETE)
+	{
+		pcx.msg = "Unexpected end of pixel data";
+		return false;
 	}
-	return success;
+	setPageLayout(pcx, PLANES, WIDTH, HEIGHT, NEW_LINE);
+	return true;
 }
-
 ImagePCX::PagePCX ImagePCX::convertToPage() const
 {
-	return {headerPCX, image, pixelData};
+	ensureDecoded();
+	return {headerPCX, image, PixelBuffer(pixelData, getMemoryResource()), "OK", paletteVGA};
 }
 
 void ImagePCX::loadImage()
 {
-	std::ifstream stream(filepath, std::ios::in | std::ios::binary);
+	SourceStream stream(filepath, options.source);
 	if (!stream)
 	{
 		this->technical.technicalMessage = "Unable to open file: " + image.name;
 		return;
 	}
-	PagePCX pcx;
-	pcx.image = image; // Sync with parent class version
-	if (readPCX(stream, pcx, 0, calcFileEnd(stream)))
+	PagePCX pcx { HeaderPCX(), image, PixelBuffer(getMemoryResource()), "OK", {} }; // Image info synced with parent class version
+	if (readPCX(stream, pcx, 0, calcFileEnd(stream), options.region, options.downscale))
 	{
 		headerPCX = pcx.header;
 		image = pcx.image;
-		pixelData = pcx.pixelData;
-		if (pcx.palette)
-			paletteVGA = std::move(pcx.palette);
+		pixelData = std::move(pcx.pixelData);
+		paletteVGA = std::move(pcx.palette);
+		this->BLUE_OFFSET = 2 * headerPCX.bytesPerLine;
+		this->ALPHA_OFFSET = 3 * headerPCX.bytesPerLine;
 		this->technical.fileState = FileState::VALID_IMAGE_FILE;
 	}
+	this->technical.technicalMessage = pcx.msg;
 }
-void ImagePCX::decodeRLE(std::ifstream& inf, std::vector<uint8_t>& imageData, const HeaderPCX& headerPCX, const uint32_t lenght)
-{
-	const long dataSize = headerPCX.bytesPerLine * headerPCX.bitsPerPixel * (headerPCX.yMax - headerPCX.yMin) + 1;
-	// Initialize vector
-	imageData.clear();
-	imageData.reserve(dataSize);
-	// Read RLE-encoded image data
-	uint8_t byte = 0;
-	int index = 0;
-	int restOfBits = 0;
-	int count = 0;
-	std::vector<uint8_t> rle(lenght);
-	inf.read(reinterpret_cast<char*>(rle.data()), lenght);
-	for (size_t i = 0; i < rle.size(); i++)
+/**
+ * Decodes rows scanlines straight into imageData, which is allocated once with the exact size.
+ * Runs are expanded with memset and never run past the buffer, whatever the data say.
+ *
+ * @return false when data ended before the last scanline
+ */
+bool ImagePCX::decodeRLE(std::istream& inf, PixelBuffer& imageData, const HeaderPCX& headerPCX, const uint32_t lenght, int rows)
+{
+	const size_t SCANLINE = static_cast<size_t>(headerPCX.bytesPerLine) * headerPCX.numOfColorPlanes;
+	imageData.assign(SCANLINE * rows, 0);
+	// Compressed data are decoded in place when the source is in memory (or mapped)
+	PixelBuffer scratch(imageData.get_allocator());
+	RunDecoder decoder(headerPCX.encoding == 1);
+	decoder.feed(readBlock(inf, lenght, scratch));
+	return decoder.fill(imageData.data(), imageData.size()) == imageData.size();
+}
+/**
+ * Decodes scanlines one at a time into a single scanline buffer and hands every complete one
+ * (all planes) to onScanline together with its index counted from firstRow.
+ * Scanlines above firstRow are decoded and dropped (uncompressed ones skipped), decoding stops after count scanlines.
+ *
+ * @return false when data ended before the last scanline
+ */
+bool ImagePCX::decodeScanlines(std::istream& inf, const HeaderPCX& headerPCX, const uint32_t lenght, int firstRow, int count,
+		const std::function<void(const uint8_t*, int)>& onScanline)
+{
+	const size_t SCANLINE = static_cast<size_t>(headerPCX.bytesPerLine) * headerPCX.numOfColorPlanes;
+	PixelBuffer scratch;
+	RunDecoder decoder(headerPCX.encoding == 1);
+	if (headerPCX.encoding == 0)
 	{
-		byte = rle[i];
-		if (byte >> 6 != 3)
-		{
-			imageData.push_back(byte);
-			index++;
-		}
-		else
-		{
-			restOfBits = byte & 0x3F;
-			i++;
-			byte = rle[i];
-			for(count = 0; count < restOfBits; count++)
-			{
-				imageData.push_back(byte);
-			}
-			index += restOfBits;
-		}
+		// Uncompressed scanlines have fixed size, so only rows from firstRow are read
+		inf.seekg(SCANLINE * firstRow, std::ios::cur);
+		decoder.feed(readBlock(inf, std::min<uint64_t>(lenght, SCANLINE * count), scratch));
+		firstRow = 0;
 	}
+	else
+	{
+		decoder.feed(readBlock(inf, lenght, scratch));
+	}
+	std::vector<uint8_t> scanline(SCANLINE);
+	for (int y = -firstRow; y < count; y++)
+	{
+		if (decoder.fill(scanline.data(), SCANLINE) < SCANLINE)
+			return false;
+		if (y >= 0)
+			onScanline(scanline.data(), y);
+	}
+	return true;
 }
 bool ImagePCX::isVGA(const HeaderPCX& headerPCX)
 {
 	return headerPCX.version == 5 && headerPCX.numOfColorPlanes == 1 && headerPCX.bitsPerPixel > 4;
 }
+bool ImagePCX::acceptLayout(ImageInfo& layout)
+{
+	const int PLANES = (layout.channels == 4 || layout.channels == 2) ? 4 : 3;
+	headerPCX = HeaderPCX();
+	headerPCX.version = 5;
+	headerPCX.encoding = 1;
+	headerPCX.bitsPerPixel = 8;
+	headerPCX.xMax = layout.width - 1;
+	headerPCX.yMax = layout.height - 1;
+	headerPCX.numOfColorPlanes = PLANES;
+	headerPCX.bytesPerLine = layout.width + (layout.width & 1); // Must be even
+	headerPCX.paletteType = 1;
+	paletteVGA.clear();
+	BLUE_OFFSET = 2 * headerPCX.bytesPerLine;
+	ALPHA_OFFSET = 3 * headerPCX.bytesPerLine;
+	layout.channels = PLANES;
+	layout.bits = PLANES * 8;
+	layout.file_type = headerPCX.file_type;
+	layout.pixelByteOrder = PixelByteOrder::RGBA;
+	layout.planar = true;
+	layout.inverted = false;
+	return true;
+}
 const ImagePCX::HeaderPCX& ImagePCX::getHeader() const
 {
+	ensureDecoded();
 	return headerPCX;
 }
 void ImagePCX::updateImage()
@@ -239,21 +368,31 @@ void ImagePCX::checkHeader(const HeaderPCX& headerPCX, const ImageInfo& image)
 {
 	if (headerPCX.file_type != 0x0A)
 		throw std::runtime_error("Unrecognized format " + image.name.substr(image.name.find_last_of(".")));
-	if ((!(headerPCX.numOfColorPlanes == 3) && (headerPCX.bitsPerPixel == 8)) &&
+	if (!((headerPCX.numOfColorPlanes == 3 || headerPCX.numOfColorPlanes == 4) && headerPCX.bitsPerPixel == 8) &&
 			(!isVGA(headerPCX))) // 24 and 32 bit images && VGA palette
 		throw std::runtime_error("This reader works only with 24-bit and 32-bit true color and VGA images");
 	if (headerPCX.version != 5)
 		throw std::runtime_error("Outdated versions are not supported");
 }
+ScanlineFormat ImagePCX::getScanlineFormat() const
+{
+	ScanlineFormat format;
+	format.channels = headerPCX.numOfColorPlanes;
+	format.pixelStride = 1;
+	format.channelStride = headerPCX.bytesPerLine;
+	format.rowStride = static_cast<size_t>(headerPCX.bytesPerLine) * headerPCX.numOfColorPlanes;
+	return format;
+}
 Pixel ImagePCX::getPixel(int x, int y) const
 {
+	ensureDecoded();
 	x = (y * headerPCX.bytesPerLine * headerPCX.numOfColorPlanes) + x;
 	Pixel pixel;
 	switch (headerPCX.numOfColorPlanes)
 	{
 		case 4:
 			pixel.alpha = pixelData[x + ALPHA_OFFSET];
-			/* no break */
+			[[fallthrough]];
 		case 3:
 			pixel.red = pixelData[x];
 			pixel.green = pixelData[x + headerPCX.bytesPerLine];
@@ -264,81 +403,229 @@ Pixel ImagePCX::getPixel(int x, int y) const
 }
 void ImagePCX::setPixel(int x, int y, Pixel newPixel)
 {
-	x = y * 3 * image.width + x;
+	ensureDecoded();
+	x = (y * headerPCX.bytesPerLine * headerPCX.numOfColorPlanes) + x;
 	switch (headerPCX.numOfColorPlanes)
 	{
 		case 4:
-			pixelData[x + 3 * image.width] = newPixel.alpha;
-			/* no break */
+			pixelData[x + ALPHA_OFFSET] = newPixel.alpha;
+			[[fallthrough]];
 		case 3:
 			pixelData[x] = newPixel.red;
-			pixelData[x + image.width]= newPixel.green;
-			pixelData[x + 2 * image.width] = newPixel.blue;
+			pixelData[x + headerPCX.bytesPerLine]= newPixel.green;
+			pixelData[x + BLUE_OFFSET] = newPixel.blue;
 		break;
 	}
 }
-bool ImagePCX::savePCX(std::ofstream& stream, const PagePCX& pcx)
+bool ImagePCX::encodePCX(const HeaderPCX& header, const PixelBuffer& pixelData, PixelBuffer& file)
 {
-	if (!stream.is_open())
-	{
+	if (header.numOfColorPlanes != 3 && header.numOfColorPlanes != 4)
 		return false;
-	}
-	stream.write(reinterpret_cast<const char*>(&pcx.header), sizeof(HeaderPCX));
-	switch (pcx.header.numOfColorPlanes)
-	{
-		case 3:
-		case 4: writePlanarPixalData(stream, pcx.pixelData); break;
-		default: return false;
-	}
+	file.clear();
+	file.reserve(sizeof(HeaderPCX) + pixelData.size() + pixelData.size() / 8);
+	// Data are always run length encoded, also for pages read from uncompressed files
+	HeaderPCX written = header;
+	written.encoding = 1;
+	file.resize(sizeof(HeaderPCX));
+	std::memcpy(file.data(), &written, sizeof(HeaderPCX));
+	encodeImageData(written, pixelData, file);
 	return true;
 }
-bool ImagePCX::saveImage() const
+bool ImagePCX::savePCX(std::ofstream& stream, const HeaderPCX& header, const PixelBuffer& pixelData, size_t* fileSize)
 {
-	std::ofstream outf(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
-	if (!outf.is_open())
+	// Whole file is built in memory, so the stream gets one write
+	PixelBuffer file(pixelData.get_allocator());
+	if (!stream.is_open() || !encodePCX(header, pixelData, file))
 	{
 		return false;
 	}
-	outf.write(reinterpret_cast<const char*>(&headerPCX), sizeof(HeaderPCX));
-	switch (headerPCX.numOfColorPlanes)
+	stream.write(reinterpret_cast<const char*>(file.data()), file.size());
+	if (fileSize)
+		*fileSize = file.size();
+	return static_cast<bool>(stream);
+}
+bool ImagePCX::saveImage() const
+{
+	ensureDecoded();
+	std::ofstream outf(filepath, std::ios::out | std::ios::binary | std::ios::trunc);
+	return savePCX(outf, headerPCX, pixelData);
+}
+size_t ImagePCX::encodeImageData(const HeaderPCX& header, const PixelBuffer& pixelData, PixelBuffer& encoded)
+{
+	const size_t START = encoded.size();
+	const size_t LINE = header.bytesPerLine;
+	for (size_t offset = 0; LINE > 0 && offset + LINE <= pixelData.size(); offset += LINE)
+		encodeScanline(pixelData.data() + offset, LINE, encoded);
+	return encoded.size() - START;
+}
+/**
+ * Every run of 2 to 63 equal bytes becomes a counter and a value, runs never cross the end of the scanline.
+ */
+void ImagePCX::encodeScanline(const uint8_t* scanline, size_t size, PixelBuffer& encoded)
+{
+	size_t i = 0;
+	while (i < size)
 	{
-		case 3:
-		case 4: writePlanarPixalData(outf, pixelData); break;
-		default:
-			//this->fileStatus = "Unexpected number of color planes";
-			outf.close();
-			return false;
+		const uint8_t VALUE = scanline[i];
+		size_t run = 1;
+		while (i + run < size && run < 63 && scanline[i + run] == VALUE)
+			run++;
+		// Single bytes with both top bits set would look like a run counter
+		if (run > 1 || VALUE >> 6 == 3)
+			encoded.push_back(static_cast<uint8_t>(0xC0 | run));
+		encoded.push_back(VALUE);
+		i += run;
 	}
-	outf.close();
-	return true;
 }
-void ImagePCX::writePlanarPixalData(std::ofstream& stream, const std::vector<unsigned char>& pixelData)
+/**
+ * Decodes one scanline at a time. Compressed data are read in chunks (in place when the file is mapped)
+ * and a run reaching into the next scanline is carried over.
+ */
+class BandReaderPCX : public BandReader
 {
-	uint8_t byte = 0;
-	size_t index = 0;
-	uint8_t numByte = 0;
-	uint8_t lastByte = 0;
-	while (index < pixelData.size())
+private:
+	static constexpr size_t CHUNK_SIZE = 64 << 10;
+	ImagePCX::HeaderPCX header;
+	PaletteLUT palette;
+	bool indexed {false};
+	PixelBuffer scratch;
+	PixelBuffer indexes; // One VGA scanline
+	ImagePCX::RunDecoder decoder;
+	bool decodeLine(uint8_t* line, size_t size)
 	{
-		byte = pixelData[index];
-		if (byte >> 6 != 3)
+		size_t filled = decoder.fill(line, size);
+		while (filled < size)
 		{
-			stream.write(reinterpret_cast<const char*>(&byte), sizeof(byte));
-			index++;
+			const std::span<const uint8_t> chunk = readBlock(stream, CHUNK_SIZE, scratch);
+			if (chunk.empty())
+				return false;
+			decoder.feed(chunk);
+			filled += decoder.fill(line + filled, size - filled);
 		}
-		else
+		return true;
+	}
+protected:
+	bool decodeRows(uint8_t* rows, int count) override
+	{
+		const size_t BYTES_PER_LINE = header.bytesPerLine;
+		for (int y = 0; y < count; y++)
+		{
+			uint8_t* row = rows + y * format.rowStride;
+			const bool DECODED = indexed ? decodeLine(indexes.data(), BYTES_PER_LINE) : decodeLine(row, format.rowStride);
+			if (!DECODED)
+			{
+				technical.technicalMessage = "Unexpected end of image data";
+				return false;
+			}
+			if (indexed)
+				palette.expandPlanar(indexes.data(), BYTES_PER_LINE, row, row + BYTES_PER_LINE, row + 2 * BYTES_PER_LINE);
+		}
+		return true;
+	}
+public:
+	BandReaderPCX(const std::string& filepath, int bandHeight, const LoadOptions& options) : BandReader(filepath, bandHeight, options),
+		scratch(band.get_allocator()), indexes(band.get_allocator()), decoder(true)
+	{
+		if (!stream)
+			return;
+		ImagePCX::readHeader(stream, header, info);
+		try
+		{
+			if (!stream)
+				throw std::runtime_error("Incomplete header");
+			ImagePCX::checkHeader(header, info);
+			if (header.encoding == 0 && !ImagePCX::isVGA(header))
+				throw std::runtime_error("Uncompressed image data are not supported for 24 and 32 bit images");
+		}
+		catch (std::runtime_error& e)
 		{
-			lastByte = byte;
-			while (pixelData[index] == lastByte && numByte < 63)
+			technical.technicalMessage = e.what();
+			return;
+		}
+		decoder = ImagePCX::RunDecoder(header.encoding == 1);
+		if (ImagePCX::isVGA(header))
+		{
+			// Palette is at the end of file, scanlines follow the header
+			const uint32_t END = ImagePCX::calcFileEnd(stream);
+			stream.seekg(END - 769);
+			uint8_t marker = 0;
+			stream.read(reinterpret_cast<char*>(&marker), 1);
+			std::vector<PixelRGB> colors(256);
+			stream.read(reinterpret_cast<char*>(colors.data()), 256 * sizeof(PixelRGB));
+			if (marker != 0x0C || !stream)
 			{
-				index++;
-				numByte++;
+				technical.technicalMessage = "Error during palete loading";
+				return;
 			}
-			numByte |= 0xC0;
-			stream.write(reinterpret_cast<const char*>(&numByte), sizeof(byte));
-			stream.write(reinterpret_cast<const char*>(&lastByte), sizeof(byte));
-			numByte = 0;
+			palette = PaletteLUT(colors);
+			indexed = true;
+			stream.seekg(sizeof(ImagePCX::HeaderPCX));
+			indexes.resize(header.bytesPerLine);
 		}
+		ImagePCX::probeHeader(header, info);
+		info.imageFormat = ImageType::PCX;
+		format.channels = info.channels;
+		format.pixelStride = 1;
+		format.channelStride = header.bytesPerLine;
+		format.rowStride = static_cast<size_t>(header.bytesPerLine) * info.channels;
+		technical.technicalMessage = "Header loaded";
+		technical.fileState = FileState::VALID_IMAGE_FILE;
 	}
+};
+/**
+ * Encodes every plane of a band separately and writes the whole band at once.
+ */
+class BandWriterPCX : public BandWriter
+{
+private:
+	PixelBuffer encoded;
+protected:
+	bool encodeRows(const uint8_t* rows, int count) override
+	{
+		encoded.clear();
+		for (int y = 0; y < count; y++)
+			for (int plane = 0; plane < format.channels; plane++)
+				ImagePCX::encodeScanline(rows + y * format.rowStride + plane * format.channelStride, format.channelStride, encoded);
+		out.write(reinterpret_cast<const char*>(encoded.data()), encoded.size());
+		return static_cast<bool>(out);
+	}
+public:
+	BandWriterPCX(const std::string& filepath, int width, int height, int channels, std::ostream* target) : BandWriter(filepath, width, height, target)
+	{
+		const int PLANES = (channels == 4 || channels == 2) ? 4 : 3;
+		ImagePCX::HeaderPCX header;
+		header.version = 5;
+		header.encoding = 1;
+		header.bitsPerPixel = 8;
+		header.xMax = width - 1;
+		header.yMax = height - 1;
+		header.numOfColorPlanes = PLANES;
+		header.bytesPerLine = width + (width & 1); // Must be even
+		header.paletteType = 1;
+		info.channels = PLANES;
+		info.bits = PLANES * 8;
+		info.file_type = header.file_type;
+		info.planar = true;
+		info.imageFormat = ImageType::PCX;
+		format.channels = PLANES;
+		format.pixelStride = 1;
+		format.channelStride = header.bytesPerLine;
+		format.rowStride = static_cast<size_t>(header.bytesPerLine) * PLANES;
+		if (width > 0xFFFF || height > 0xFFFF)
+		{
+			technical.technicalMessage = "Image is too large for PCX";
+			technical.fileState = FileState::INVALID_IMAGE_FILE;
+		}
+		if (isValid())
+			out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	}
+};
+std::unique_ptr<BandReader> ImagePCX::openBandReader(const std::string& filepath, int bandHeight, const LoadOptions& options)
+{
+	return std::make_unique<BandReaderPCX>(filepath, bandHeight, options);
+}
+std::unique_ptr<BandWriter> ImagePCX::createBandWriter(const std::string& filepath, int width, int height, int channels, std::ostream* target)
+{
+	return std::make_unique<BandWriterPCX>(filepath, width, height, channels, target);
 }
 } /* namespace consoleartlib */
@@ -2,7 +2,7 @@
 // File       : ImagePNG.cpp
 // Author     : riyufuchi
 // Created on : Feb 17, 2025
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -16,9 +16,12 @@
 
 namespace consoleartlib
 {
-ImagePNG::ImagePNG(const std::string& filepath) : Image(filepath, ImageType::PNG)
+ImagePNG::ImagePNG(const std::string& filepath, const LoadOptions& options) : Image(filepath, ImageType::PNG, options)
 {
-	loadImage();
+	if (options.deferDecode)
+		deferDecode(probe(filepath, image, options.source));
+	else
+		loadImage();
 }
 ImagePNG::ImagePNG(const std::string& filepath, int width, int height, int channels) : Image(filepath, ImageType::PNG)
 {
@@ -38,16 +41,35 @@ ImagePNG::ImagePNG(const std::string& filepath, int width, int height, int chann
 		break;
 	}
 
-	pixelData.resize(width * height * channels); // This also zero fills
+	pixelData.resize(getRowStride() * height); // This also zero fills
 }
 
 ImagePNG::~ImagePNG()
 {
 }
+/**
+ * Reads only the header through stb.
+ */
+TechnicalInfo ImagePNG::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	TechnicalInfo technical;
+	const int OK = source.empty() ? stbi_info(filepath.c_str(), &info.width, &info.height, &info.channels)
+		: stbi_info_from_memory(source.data(), static_cast<int>(source.size()), &info.width, &info.height, &info.channels);
+	if (!OK)
+	{
+		technical.technicalMessage = stbi_failure_reason();
+		return technical;
+	}
+	info.bits = info.channels * 8;
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
+}
 
 consoleartlib::Pixel ImagePNG::getPixel(int x, int y) const
 {
-	x = image.channels * (y * image.width + x);
+	ensureDecoded();
+	x = y * getRowStride() + x * image.channels;
 	if (image.channels == 4)
 		return {pixelData[x], pixelData[x + 1], pixelData[x + 2], pixelData[x + 3]};
 	else
@@ -55,7 +77,8 @@ consoleartlib::Pixel ImagePNG::getPixel(int x, int y) const
 }
 void ImagePNG::setPixel(int x, int y, consoleartlib::Pixel newPixel)
 {
-	x = image.channels * (y * image.width + x);
+	ensureDecoded();
+	x = y * getRowStride() + x * image.channels;
 	pixelData[x] = newPixel.red;
 	pixelData[x + 1] = newPixel.green;
 	pixelData[x + 2] = newPixel.blue;
@@ -64,20 +87,120 @@ void ImagePNG::setPixel(int x, int y, consoleartlib::Pixel newPixel)
 }
 bool ImagePNG::saveImage() const
 {
-	return stbi_write_png(filepath.c_str(), image.width, image.height, image.channels, pixelData.data(), image.width * image.channels);
+	ensureDecoded();
+	return stbi_write_png(filepath.c_str(), image.width, image.height, image.channels, pixelData.data(), static_cast<int>(getRowStride()));
 }
 void ImagePNG::loadImage()
 {
-	unsigned char* imageData = stbi_load(filepath.c_str(), &image.width, &image.height, &image.channels, 0);
+	unsigned char* imageData = options.source.empty() ? stbi_load(filepath.c_str(), &image.width, &image.height, &image.channels, 0)
+		: stbi_load_from_memory(options.source.data(), static_cast<int>(options.source.size()), &image.width, &image.height, &image.channels, 0);
 	if (imageData == nullptr)
 	{
 		technical.technicalMessage = "Loading of " + filepath + " failed";
 		return;
 	}
+	// stb decodes whole image, only the region is kept (reduced when downscaling)
+	const ImageRegion REGION = clipRegion(options.region, image.width, image.height);
+	const int FULL_WIDTH = image.width;
+	image.width = reducedSize(REGION.width, options.downscale);
+	image.height = reducedSize(REGION.height, options.downscale);
 	image.bits = image.channels * 8;
-	pixelData.resize(image.width * image.height * image.channels); // Resize the class vector to hold image data
-	std::memcpy(pixelData.data(), imageData, pixelData.size()); // Copy the raw bytes
+	if (!REGION.isEmpty())
+		importRegion(imageData, FULL_WIDTH, REGION); // Copy the raw bytes
 	stbi_image_free(imageData); // Always free the original STB data
+	if (REGION.isEmpty())
+	{
+		technical.technicalMessage = "Region lies outside of the image";
+		return;
+	}
 	technical.fileState =  FileState::VALID_IMAGE_FILE;
 }
+/**
+ * Encoded file is read through stb callbacks, decoded pixels are handed out band by band.
+ */
+class BandReaderPNG : public BandReader
+{
+private:
+	std::unique_ptr<uint8_t, void (*)(void*)> decoded;
+	static int read(void* user, char* data, int size)
+	{
+		std::istream* stream = static_cast<std::istream*>(user);
+		stream->read(data, size);
+		return static_cast<int>(stream->gcount());
+	}
+	static void skip(void* user, int count)
+	{
+		static_cast<std::istream*>(user)->seekg(count, std::ios::cur);
+	}
+	static int eof(void* user)
+	{
+		return static_cast<std::istream*>(user)->eof();
+	}
+protected:
+	bool decodeRows(uint8_t* rows, int count) override
+	{
+		std::memcpy(rows, decoded.get() + nextRow * format.rowStride, format.rowStride * count);
+		return true;
+	}
+public:
+	BandReaderPNG(const std::string& filepath, int bandHeight, const LoadOptions& options) : BandReader(filepath, bandHeight, options),
+		decoded(nullptr, stbi_image_free)
+	{
+		if (!stream)
+			return;
+		const stbi_io_callbacks CALLBACKS { read, skip, eof };
+		decoded.reset(stbi_load_from_callbacks(&CALLBACKS, &stream, &info.width, &info.height, &info.channels, 0));
+		if (!decoded)
+		{
+			technical.technicalMessage = stbi_failure_reason();
+			return;
+		}
+		info.bits = info.channels * 8;
+		info.imageFormat = ImageType::PNG;
+		format.channels = info.channels;
+		format.pixelStride = info.channels;
+		format.rowStride = static_cast<size_t>(info.width) * info.channels;
+		technical.technicalMessage = "Image decoded";
+		technical.fileState = FileState::VALID_IMAGE_FILE;
+	}
+};
+class BandWriterPNG : public BandWriter
+{
+private:
+	PixelBuffer pixels;
+	static void write(void* user, void* data, int size)
+	{
+		static_cast<std::ostream*>(user)->write(static_cast<const char*>(data), size);
+	}
+protected:
+	bool encodeRows(const uint8_t* rows, int count) override
+	{
+		pixels.insert(pixels.end(), rows, rows + format.rowStride * count);
+		return true;
+	}
+	bool finishFile() override
+	{
+		return stbi_write_png_to_func(write, &out, info.width, info.height, info.channels, pixels.data(), static_cast<int>(format.rowStride)) && out;
+	}
+public:
+	BandWriterPNG(const std::string& filepath, int width, int height, int channels, std::ostream* target) : BandWriter(filepath, width, height, target)
+	{
+		info.channels = std::clamp(channels, 1, 4);
+		info.bits = info.channels * 8;
+		info.imageFormat = ImageType::PNG;
+		format.channels = info.channels;
+		format.pixelStride = info.channels;
+		format.rowStride = static_cast<size_t>(width) * info.channels;
+		if (isValid())
+			pixels.reserve(format.rowStride * height);
+	}
+};
+std::unique_ptr<BandReader> ImagePNG::openBandReader(const std::string& filepath, int bandHeight, const LoadOptions& options)
+{
+	return std::make_unique<BandReaderPNG>(filepath, bandHeight, options);
+}
+std::unique_ptr<BandWriter> ImagePNG::createBandWriter(const std::string& filepath, int width, int height, int channels, std::ostream* target)
+{
+	return std::make_unique<BandWriterPNG>(filepath, width, height, channels, target);
+}
 } /* namespace consoleartlib */
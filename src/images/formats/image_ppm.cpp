@@ -2,7 +2,7 @@
 // File       : ImagePPM.cpp
 // Author     : riyufuchi
 // Created on : Mar 17, 2024
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2024, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -11,94 +11,210 @@
 
 namespace consoleartlib
 {
-ImagePPM::ImagePPM(const std::string& filename) : Image(filename, ImageType::PPM)
+ImagePPM::ImagePPM(const std::string& filename, const LoadOptions& options) : Image(filename, ImageType::PPM, options)
 {
-	loadImage();
-	image.width = headerPPM.width;
-	image.height = headerPPM.height;
-	image.file_type = 806;
+	if (options.deferDecode)
+		deferDecode(probe(filepath, image, options.source));
+	else
+		loadImage();
 }
 ImagePPM::ImagePPM(const std::string& filename, int w, int h) : Image(filename, ImageType::PPM)
 {
 	headerPPM.width = w;
 	headerPPM.height = h;
-	pixelData.resize(w * h * 3);
-	for (size_t x = 0; x < pixelData.size(); x++)
-		pixelData.emplace_back(255);
 	// Image info
 	image.width = headerPPM.width;
 	image.height = headerPPM.height;
+	image.channels = 3;
+	image.bits = 24;
 	image.file_type = 806;
+	pixelData.assign(getRowStride() * h, 255); // White canvas
 }
 ImagePPM::~ImagePPM()
 {
 }
-void ImagePPM::loadImage()
+TechnicalInfo ImagePPM::readHeader(std::istream& inf, HeaderPPM& header)
 {
-	std::ifstream inf(filepath, std::ios::in);
-	if (!inf)
-	{
-		this->technical.technicalMessage = "Unable to open file: " + image.name;
-		return;
-	}
+	TechnicalInfo technical;
 	std::string line;
 	std::string byte;
-	std::getline(inf, line);
+	// Stream is binary, so line ends of files written on Windows keep their \r
+	auto readLine = [&inf](std::string& text)
+	{
+		std::getline(inf, text);
+		if (!text.empty() && text.back() == '\r')
+			text.pop_back();
+	};
+	readLine(line);
 	if (line != "P3" && line != "P6")
 	{
-		this->technical.technicalMessage = "Not a PPM file: " + image.name;
-		return;
+		technical.technicalMessage = "Not a PPM file";
+		return technical;
 	}
+	header.format = line;
 
-	std::getline(inf, line);
+	readLine(line);
 	std::istringstream iss(line);
 	if (iss >> byte)
 	{
 		if (consolelib::data_tools::isNumber(byte))
-			headerPPM.width = std::stoi(byte);
+			header.width = std::stoi(byte);
 		else
 		{
-			this->technical.technicalMessage = "Missing width info";
-			return;
+			technical.technicalMessage = "Missing width info";
+			return technical;
 		}
 	}
 	if (iss >> byte)
 	{
 		if (consolelib::data_tools::isNumber(byte))
-			headerPPM.height = std::stoi(byte);
+			header.height = std::stoi(byte);
 		else
 		{
-			this->technical.technicalMessage = "Missing height info";
-			return;
+			technical.technicalMessage = "Missing height info";
+			return technical;
 		}
 	}
-	std::getline(inf, line);
+	readLine(line);
 	if (consolelib::data_tools::isNumber(line))
-		headerPPM.maxColorVal = std::stoi(line);
+		header.maxColorVal = std::stoi(line);
 	else
 	{
-		this->technical.technicalMessage = "Missing color info";
+		technical.technicalMessage = "Missing color info";
+		return technical;
+	}
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
+}
+TechnicalInfo ImagePPM::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	SourceStream inf(filepath, source);
+	if (!inf)
+		return {"Unable to open file: " + filepath, FileState::INVALID_IMAGE_FILE};
+	HeaderPPM header;
+	TechnicalInfo technical = readHeader(inf, header);
+	if (technical.fileState != FileState::VALID_IMAGE_FILE)
+		return technical;
+	info.width = header.width;
+	info.height = header.height;
+	info.channels = 3;
+	info.bits = 24;
+	info.file_type = 806;
+	technical.technicalMessage = "Header loaded";
+	return technical;
+}
+void ImagePPM::loadImage()
+{
+	SourceStream inf(filepath, options.source);
+	if (!inf)
+	{
+		this->technical.technicalMessage = "Unable to open file: " + image.name;
 		return;
 	}
-
-	pixelData.resize(headerPPM.width * headerPPM.height * 3);
+	TechnicalInfo headerState = readHeader(inf, headerPPM);
+	if (headerState.fileState != FileState::VALID_IMAGE_FILE)
+	{
+		this->technical.technicalMessage = headerState.technicalMessage + ": " + image.name;
+		return;
+	}
+	const ImageRegion REGION = clipRegion(options.region, headerPPM.width, headerPPM.height);
+	if (REGION.isEmpty())
+	{
+		this->technical.technicalMessage = "Region lies outside of the image";
+		return;
+	}
+	const size_t FULL_ROW_SIZE = headerPPM.width * 3;
+	const size_t FIRST = REGION.x * 3;
+	const size_t SOURCE_ROW = REGION.width * 3;
+	const int SCALE = options.downscale;
+	headerPPM.width = reducedSize(REGION.width, SCALE);
+	headerPPM.height = reducedSize(REGION.height, SCALE);
+	image.width = headerPPM.width;
+	image.height = headerPPM.height;
+	image.channels = 3;
+	image.bits = 24;
+	image.file_type = 806;
+	const size_t STRIDE = getRowStride();
+	pixelData.resize(STRIDE * headerPPM.height);
+	BoxFilter<uint8_t> filter(REGION.width, 3, SCALE);
+	if (headerPPM.format == "P6")
+	{
+		if (headerPPM.maxColorVal > 255)
+		{
+			this->technical.technicalMessage = "16-bit PPM images are not supported: " + image.name;
+			return;
+		}
+		// Binary samples are copied straight from the (usually mapped) file, rows above the region are skipped
+		if (REGION.y > 0)
+			inf.seekg(REGION.y * FULL_ROW_SIZE, std::ios::cur);
+		PixelBuffer scratch(pixelData.get_allocator());
+		const size_t SIZE = (REGION.height - 1) * FULL_ROW_SIZE + FIRST + SOURCE_ROW;
+		const std::span<const uint8_t> block = readBlock(inf, SIZE, scratch);
+		if (block.size() < SIZE)
+		{
+			invalidate("Unexpected end of pixel data");
+			return;
+		}
+		for (int y = 0; y < REGION.height; y++)
+		{
+			const uint8_t* row = block.data() + y * FULL_ROW_SIZE + FIRST;
+			if (SCALE == 1)
+			{
+				std::memcpy(pixelData.data() + y * STRIDE, row, SOURCE_ROW);
+				continue;
+			}
+			filter.addRow(row);
+			if ((y + 1) % SCALE == 0 || y == REGION.height - 1)
+				filter.flushRow(pixelData.data() + y / SCALE * STRIDE);
+		}
+		this->technical.fileState = FileState::VALID_IMAGE_FILE;
+		return;
+	}
+	// Text samples have to be parsed in order, parsing stops after the last row of the region
+	std::string line;
+	std::string byte;
+	std::istringstream iss;
+	const size_t START = REGION.y * FULL_ROW_SIZE;
+	const size_t END = (REGION.y + REGION.height) * FULL_ROW_SIZE;
+	std::vector<uint8_t> row(SCALE > 1 ? SOURCE_ROW : 0); // Rows are collected here when downscaling
 	size_t color = 0;
-	while (std::getline(inf, line))
+	while (color < END && std::getline(inf, line))
 	{
 		iss = std::istringstream(line);
-		while (iss >> byte)
+		while (color < END && iss >> byte)
 		{
-			pixelData[color] = static_cast<uint8_t>(std::stoi(byte));
+			const size_t COLUMN = color % FULL_ROW_SIZE - FIRST; // Wraps around left of the region
+			const int Y = static_cast<int>(color / FULL_ROW_SIZE) - REGION.y;
 			color++;
+			if (color <= START || COLUMN >= SOURCE_ROW)
+				continue;
+			if (SCALE == 1)
+			{
+				pixelData[Y * STRIDE + COLUMN] = static_cast<uint8_t>(std::stoi(byte));
+				continue;
+			}
+			row[COLUMN] = static_cast<uint8_t>(std::stoi(byte));
+			if (COLUMN + 1 < SOURCE_ROW)
+				continue;
+			filter.addRow(row.data());
+			if ((Y + 1) % SCALE == 0 || Y == REGION.height - 1)
+				filter.flushRow(pixelData.data() + Y / SCALE * STRIDE);
 		}
 	}
+	if (color < END)
+	{
+		invalidate("Unexpected end of pixel data");
+		return;
+	}
 	this->technical.fileState =  FileState::VALID_IMAGE_FILE;
 }
 void ImagePPM::virtualArtistLegacy()
 {
 	headerPPM.width = 255;
 	headerPPM.height = 255;
-	pixelData.resize(headerPPM.width * headerPPM.height * 3);
+	image.width = headerPPM.width;
+	image.height = headerPPM.height;
+	pixelData.resize(getRowStride() * headerPPM.height);
 
 	const int MOD = 256;
 
@@ -107,20 +223,38 @@ void ImagePPM::virtualArtistLegacy()
 			setPixel(x, y, Pixel{(uint8_t)(x % MOD), (uint8_t)(y % MOD), (uint8_t)(x * y % MOD)});
 	saveImage();
 }
+bool ImagePPM::acceptLayout(ImageInfo& layout)
+{
+	headerPPM.width = layout.width;
+	headerPPM.height = layout.height;
+	layout.channels = 3;
+	layout.bits = 24;
+	layout.file_type = 806;
+	layout.pixelByteOrder = PixelByteOrder::RGBA;
+	layout.planar = false;
+	layout.inverted = false;
+	return true;
+}
 // Overrides
 Pixel ImagePPM::getPixel(int x, int y) const
 {
-	return {pixelData[y * headerPPM.width + x], pixelData[y * headerPPM.width + x + 1], pixelData[y * headerPPM.width + x + 2]};
+	ensureDecoded();
+	x = y * getRowStride() + x * 3;
+	return {pixelData[x], pixelData[x + 1], pixelData[x + 2]};
 }
 void ImagePPM::setPixel(int x, int y, Pixel newPixel)
 {
-	pixelData[y * headerPPM.width + x] = newPixel.red;
-	pixelData[y * headerPPM.width + x + 1] = newPixel.green;
-	pixelData[y * headerPPM.width + x + 2] = newPixel.blue;
+	ensureDecoded();
+	x = y * getRowStride() + x * 3;
+	pixelData[x] = newPixel.red;
+	pixelData[x + 1] = newPixel.green;
+	pixelData[x + 2] = newPixel.blue;
 }
 bool ImagePPM::saveImage() const
 {
-	std::ofstream outf(filepath, std::ios::out | std::ios::trunc);
+	ensureDecoded();
+	const bool BINARY = (headerPPM.format == "P6");
+	std::ofstream outf(filepath, BINARY ? std::ios::out | std::ios::trunc | std::ios::binary : std::ios::out | std::ios::trunc);
 	if (!outf.is_open())
 	{
 		return false;
@@ -130,6 +264,14 @@ bool ImagePPM::saveImage() const
 	outf << headerPPM.width << " " << headerPPM.height << "\n";
 	outf << headerPPM.maxColorVal << "\n";
 
+	if (BINARY)
+	{
+		const size_t ROW_SIZE = headerPPM.width * 3;
+		for (int y = 0; y < headerPPM.height; y++)
+			outf.write(reinterpret_cast<const char*>(pixelData.data() + y * getRowStride()), ROW_SIZE);
+		return static_cast<bool>(outf);
+	}
+
 	Pixel p;
 	const int MAX_X = headerPPM.width - 1;
 
@@ -146,4 +288,93 @@ bool ImagePPM::saveImage() const
 	outf.close();
 	return true;
 }
+/**
+ * Binary P6 rows are taken in place from the (usually mapped) file, text P3 samples are parsed as they come.
+ */
+class BandReaderPPM : public BandReader
+{
+private:
+	bool binary;
+	PixelBuffer scratch;
+protected:
+	bool decodeRows(uint8_t* rows, int count) override
+	{
+		const size_t SIZE = format.rowStride * count;
+		if (binary)
+		{
+			const std::span<const uint8_t> block = readBlock(stream, SIZE, scratch);
+			if (block.size() < SIZE)
+			{
+				technical.technicalMessage = "Unexpected end of pixel data";
+				return false;
+			}
+			std::memcpy(rows, block.data(), SIZE);
+			return true;
+		}
+		int sample = 0;
+		for (size_t i = 0; i < SIZE; i++)
+		{
+			if (!(stream >> sample))
+			{
+				technical.technicalMessage = "Unexpected end of pixel data";
+				return false;
+			}
+			rows[i] = static_cast<uint8_t>(sample);
+		}
+		return true;
+	}
+public:
+	BandReaderPPM(const std::string& filepath, int bandHeight, const LoadOptions& options) : BandReader(filepath, bandHeight, options),
+		binary(false), scratch(band.get_allocator())
+	{
+		if (!stream)
+			return;
+		ImagePPM::HeaderPPM header;
+		technical = ImagePPM::readHeader(stream, header);
+		if (technical.fileState != FileState::VALID_IMAGE_FILE)
+			return;
+		if (header.maxColorVal > 255 || header.width <= 0 || header.height <= 0)
+		{
+			technical = {"Unsupported PPM image", FileState::INVALID_IMAGE_FILE};
+			return;
+		}
+		binary = (header.format == "P6");
+		info.width = header.width;
+		info.height = header.height;
+		info.channels = 3;
+		info.bits = 24;
+		info.file_type = 806;
+		info.imageFormat = ImageType::PPM;
+		format.rowStride = static_cast<size_t>(header.width) * 3;
+		technical.technicalMessage = "Header loaded";
+	}
+};
+class BandWriterPPM : public BandWriter
+{
+protected:
+	bool encodeRows(const uint8_t* rows, int count) override
+	{
+		out.write(reinterpret_cast<const char*>(rows), format.rowStride * count);
+		return static_cast<bool>(out);
+	}
+public:
+	BandWriterPPM(const std::string& filepath, int width, int height, std::ostream* target) : BandWriter(filepath, width, height, target)
+	{
+		info.channels = 3;
+		info.bits = 24;
+		info.file_type = 806;
+		info.imageFormat = ImageType::PPM;
+		format.rowStride = static_cast<size_t>(width) * 3;
+		if (isValid())
+			out << "P6\n" << width << " " << height << "\n255\n";
+	}
+};
+std::unique_ptr<BandReader> ImagePPM::openBandReader(const std::string& filepath, int bandHeight, const LoadOptions& options)
+{
+	return std::make_unique<BandReaderPPM>(filepath, bandHeight, options);
+}
+std::unique_ptr<BandWriter> ImagePPM::createBandWriter(const std::string& filepath, int width, int height, std::ostream* target)
+{
+	return std::make_unique<BandWriterPPM>(filepath, width, height, target);
+}
 } /* namespace consoleartlib */
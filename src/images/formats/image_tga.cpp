@@ -2,7 +2,7 @@
 // File       : ImageTGA.cpp
 // Author     : riyufuchi
 // Created on : Nov 07, 2025
-// Last edit  : Dec 16, 2025
+// Last edit  : Oct 17, 2026
 // Copyright  : Copyright (c) 2025, riyufuchi
 // Description: consoleart
 //==============================================================================
@@ -14,14 +14,37 @@
 namespace consoleartlib
 {
 
-ImageTGA::ImageTGA(const std::string& filename) : Image(filename, ImageType::TGA)
+ImageTGA::ImageTGA(const std::string& filename, const LoadOptions& options) : Image(filename, ImageType::TGA, options)
 {
-	loadImage();
+	if (options.deferDecode)
+		deferDecode(probe(filepath, image, options.source));
+	else
+		loadImage();
+}
+
+/**
+ * Reads only the header through stb.
+ */
+TechnicalInfo ImageTGA::probe(const std::string& filepath, ImageInfo& info, std::span<const uint8_t> source)
+{
+	TechnicalInfo technical;
+	const int OK = source.empty() ? stbi_info(filepath.c_str(), &info.width, &info.height, &info.channels)
+		: stbi_info_from_memory(source.data(), static_cast<int>(source.size()), &info.width, &info.height, &info.channels);
+	if (!OK)
+	{
+		technical.technicalMessage = stbi_failure_reason();
+		return technical;
+	}
+	info.bits = info.channels * 8;
+	technical.technicalMessage = "Header loaded";
+	technical.fileState = FileState::VALID_IMAGE_FILE;
+	return technical;
 }
 
 consoleartlib::Pixel ImageTGA::getPixel(int x, int y) const
 {
-	x = image.channels * (y * image.width + x);
+	ensureDecoded();
+	x = y * getRowStride() + x * image.channels;
 	if (image.channels == 4)
 		return {pixelData[x], pixelData[x + 1], pixelData[x + 2], pixelData[x + 3]};
 	else
@@ -30,7 +53,8 @@ consoleartlib::Pixel ImageTGA::getPixel(int x, int y) const
 
 void ImageTGA::setPixel(int x, int y, consoleartlib::Pixel newPixel)
 {
-	x = image.channels * (y * image.width + x);
+	ensureDecoded();
+	x = y * getRowStride() + x * image.channels;
 	pixelData[x] = newPixel.red;
 	pixelData[x + 1] = newPixel.green;
 	pixelData[x + 2] = newPixel.blue;
@@ -40,22 +64,72 @@ void ImageTGA::setPixel(int x, int y, consoleartlib::Pixel newPixel)
 
 bool ImageTGA::saveImage() const
 {
-	return stbi_write_tga(filepath.c_str(), image.width, image.height, image.channels, pixelData.data());
+	ensureDecoded();
+	PixelBuffer packed;
+	return stbi_write_tga(filepath.c_str(), image.width, image.height, image.channels, exportRows(packed));
 }
 
 void ImageTGA::loadImage()
 {
-	unsigned char* imageData = stbi_load(filepath.c_str(), &image.width, &image.height, &image.channels, 0);
+	unsigned char* imageData = options.source.empty() ? stbi_load(filepath.c_str(), &image.width, &image.height, &image.channels, 0)
+		: stbi_load_from_memory(options.source.data(), static_cast<int>(options.source.size()), &image.width, &image.height, &image.channels, 0);
 	if (imageData == nullptr)
 	{
 		technical.technicalMessage = "Loading of " + filepath + " failed";
 		return;
 	}
+	// stb decodes whole image, only the region is kept (reduced when downscaling)
+	const ImageRegion REGION = clipRegion(options.region, image.width, image.height);
+	const int FULL_WIDTH = image.width;
+	image.width = reducedSize(REGION.width, options.downscale);
+	image.height = reducedSize(REGION.height, options.downscale);
 	image.bits = image.channels * 8;
-	pixelData.resize(image.width * image.height * image.channels); // Resize the class vector to hold image data
-	std::memcpy(pixelData.data(), imageData, pixelData.size()); // Copy the raw bytes
+	if (!REGION.isEmpty())
+		importRegion(imageData, FULL_WIDTH, REGION); // Copy the raw bytes
 	stbi_image_free(imageData); // Always free the original STB data
+	if (REGION.isEmpty())
+	{
+		technical.technicalMessage = "Region lies outside of the image";
+		return;
+	}
 	technical.fileState =  FileState::VALID_IMAGE_FILE;
 }
 
+class BandWriterTGA : public BandWriter
+{
+private:
+	PixelBuffer pixels;
+	static void write(void* user, void* data, int size)
+	{
+		static_cast<std::ostream*>(user)->write(static_cast<const char*>(data), size);
+	}
+protected:
+	bool encodeRows(const uint8_t* rows, int count) override
+	{
+		pixels.insert(pixels.end(), rows, rows + format.rowStride * count);
+		return true;
+	}
+	bool finishFile() override
+	{
+		return stbi_write_tga_to_func(write, &out, info.width, info.height, info.channels, pixels.data()) && out;
+	}
+public:
+	BandWriterTGA(const std::string& filepath, int width, int height, int channels, std::ostream* target) : BandWriter(filepath, width, height, target)
+	{
+		info.channels = std::clamp(channels, 1, 4);
+		info.bits = info.channels * 8;
+		info.imageFormat = ImageType::TGA;
+		format.channels = info.channels;
+		format.pixelStride = info.channels;
+		format.rowStride = static_cast<size_t>(width) * info.channels;
+		if (isValid())
+			pixels.reserve(format.rowStride * height);
+	}
+};
+
+std::unique_ptr<BandWriter> ImageTGA::createBandWriter(const std::string& filepath, int width, int height, int channels, std::ostream* target)
+{
+	return std::make_unique<BandWriterTGA>(filepath, width, height, channels, target);
+}
+
 } /* namespace consoleartlib */
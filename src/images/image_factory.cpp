@@ -0,0 +1,131 @@
+//==============================================================================
+// File       : ImageFactory.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Creating images without knowing the concrete format class
+//==============================================================================
+
+#include "../consoleartlib/images/image_factory.h"
+
+namespace consoleartlib::image_factory
+{
+static bool startsWith(std::span<const uint8_t> header, std::string_view signature)
+{
+	return header.size() >= signature.size() && std::equal(signature.begin(), signature.end(), header.begin(),
+			[](char a, uint8_t b) { return static_cast<uint8_t>(a) == b; });
+}
+static bool hasExtension(const std::string& filepath, std::string_view extension)
+{
+	if (filepath.size() < extension.size())
+		return false;
+	return std::equal(extension.rbegin(), extension.rend(), filepath.rbegin(),
+			[](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); });
+}
+ImageType detectFormat(std::span<const uint8_t> header)
+{
+	if (startsWith(header, "\x89PNG\r\n\x1A\n"))
+		return ImageType::PNG;
+	if (startsWith(header, "\xFF\xD8\xFF"))
+		return ImageType::JPG;
+	if (startsWith(header, "GIF87a") || startsWith(header, "GIF89a"))
+		return ImageType::GIF;
+	if (startsWith(header, "#?RADIANCE") || startsWith(header, "#?RGBE"))
+		return ImageType::HDR;
+	if (startsWith(header, "\xB1\x68\xDE\x3A")) // 0x3ADE68B1 little endian
+		return ImageType::DCX;
+	if (startsWith(header, "BM"))
+		return ImageType::BMP;
+	// Manufacturer 0x0A, known version and RLE or no encoding
+	if (header.size() >= 3 && header[0] == 0x0A && (header[1] <= 5 && header[1] != 1) && header[2] <= 1)
+		return ImageType::PCX;
+	if ((startsWith(header, "P3") || startsWith(header, "P6")) && header.size() > 2 && std::isspace(header[2]))
+		return ImageType::PPM;
+	return ImageType::UNKNOWN;
+}
+ImageType detectFormat(const std::string& filepath)
+{
+	uint8_t header[16] {};
+	std::ifstream inf(filepath, std::ios::in | std::ios::binary);
+	if (!inf)
+		return ImageType::UNKNOWN;
+	inf.read(reinterpret_cast<char*>(header), sizeof(header));
+	ImageType type = detectFormat(std::span<const uint8_t>(header, inf.gcount()));
+	if (type == ImageType::UNKNOWN && hasExtension(filepath, ".tga"))
+		return ImageType::TGA;
+	return type;
+}
+static std::unique_ptr<Image> create(const std::string& filepath, ImageType type, const LoadOptions& options)
+{
+	switch (type)
+	{
+		case ImageType::BMP: return std::make_unique<ImageBMP>(filepath, options);
+		case ImageType::PCX: return std::make_unique<ImagePCX>(filepath, options);
+		case ImageType::DCX: return std::make_unique<ImageDCX>(filepath, options);
+		case ImageType::PPM: return std::make_unique<ImagePPM>(filepath, options);
+		case ImageType::PNG: return std::make_unique<ImagePNG>(filepath, options);
+		case ImageType::JPG: return std::make_unique<ImageJPG>(filepath, options);
+		case ImageType::GIF: return std::make_unique<ImageGIF>(filepath, options);
+		case ImageType::HDR: return std::make_unique<ImageHDR>(filepath, true, options);
+		case ImageType::TGA: return std::make_unique<ImageTGA>(filepath, options);
+		case ImageType::UNKNOWN: break;
+	}
+	return nullptr;
+}
+std::unique_ptr<Image> open(const std::string& filepath, const LoadOptions& options)
+{
+	return create(filepath, detectFormat(filepath), options);
+}
+std::unique_ptr<Image> open(std::span<const uint8_t> memory, const std::string& name, LoadOptions options)
+{
+	ImageType type = detectFormat(memory.first(std::min<size_t>(memory.size(), 16)));
+	if (type == ImageType::UNKNOWN && hasExtension(name, ".tga"))
+		type = ImageType::TGA;
+	options.source = memory;
+	return create(name, type, options);
+}
+TechnicalInfo probe(const std::string& filepath, ImageType type, ImageInfo& info, std::span<const uint8_t> source)
+{
+	info.name = filepath.substr(filepath.find_last_of('/') + 1);
+	info.imageFormat = type;
+	switch (type)
+	{
+		case ImageType::BMP: return ImageBMP::probe(filepath, info, source);
+		case ImageType::PCX: return ImagePCX::probe(filepath, info, source);
+		case ImageType::DCX: return ImageDCX::probe(filepath, info, source);
+		case ImageType::PPM: return ImagePPM::probe(filepath, info, source);
+		case ImageType::PNG: return ImagePNG::probe(filepath, info, source);
+		case ImageType::JPG: return ImageJPG::probe(filepath, info, source);
+		case ImageType::GIF: return ImageGIF::probe(filepath, info, source);
+		case ImageType::HDR: return ImageHDR::probe(filepath, info, source);
+		case ImageType::TGA: return ImageTGA::probe(filepath, info, source);
+		case ImageType::UNKNOWN: break;
+	}
+	return {"Unknown image format: " + info.name, FileState::INVALID_IMAGE_FILE};
+}
+std::unique_ptr<BandReader> openBandReader(const std::string& filepath, int bandHeight, const LoadOptions& options)
+{
+	const ImageType TYPE = options.source.empty() ? detectFormat(filepath) : detectFormat(options.source.first(std::min<size_t>(options.source.size(), 16)));
+	switch (TYPE)
+	{
+		case ImageType::BMP: return ImageBMP::openBandReader(filepath, bandHeight, options);
+		case ImageType::PCX: return ImagePCX::openBandReader(filepath, bandHeight, options);
+		case ImageType::PPM: return ImagePPM::openBandReader(filepath, bandHeight, options);
+		case ImageType::PNG: return ImagePNG::openBandReader(filepath, bandHeight, options);
+		default: return nullptr;
+	}
+}
+std::unique_ptr<BandWriter> createBandWriter(const std::string& filepath, ImageType type, int width, int height, int channels, std::ostream* target)
+{
+	switch (type)
+	{
+		case ImageType::BMP: return ImageBMP::createBandWriter(filepath, width, height, channels, target);
+		case ImageType::PCX: return ImagePCX::createBandWriter(filepath, width, height, channels, target);
+		case ImageType::PPM: return ImagePPM::createBandWriter(filepath, width, height, target);
+		case ImageType::PNG: return ImagePNG::createBandWriter(filepath, width, height, channels, target);
+		case ImageType::TGA: return ImageTGA::createBandWriter(filepath, width, height, channels, target);
+		default: return nullptr;
+	}
+}
+} /* namespace consoleartlib::image_factory */
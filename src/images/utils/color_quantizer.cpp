@@ -0,0 +1,190 @@
+//==============================================================================
+// File       : ColorQuantizer.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Reducing colors of RGBA pixels to a palette
+//==============================================================================
+
+#include "../../consoleartlib/images/utils/color_quantizer.h"
+
+#include <algorithm>
+
+namespace consoleartlib
+{
+static constexpr uint16_t NO_INDEX = 0xFFFF;
+
+ColorQuantizer::ColorQuantizer(int maxColors) : maxColors(std::clamp(maxColors, 1, 256)), counts(BINS, 0), sums(BINS * 3, 0), overflow(false)
+{
+}
+void ColorQuantizer::addColor(uint8_t red, uint8_t green, uint8_t blue)
+{
+	const size_t BIN = binOf(red, green, blue);
+	counts[BIN]++;
+	sums[BIN * 3] += red;
+	sums[BIN * 3 + 1] += green;
+	sums[BIN * 3 + 2] += blue;
+	if (overflow)
+		return;
+	exact.insert((static_cast<uint32_t>(red) << 16) | (green << 8) | blue);
+	if (exact.size() > static_cast<size_t>(maxColors))
+	{
+		overflow = true;
+		exact.clear();
+	}
+}
+void ColorQuantizer::addPixels(const uint8_t* rgba, size_t count)
+{
+	for (size_t i = 0; i < count; i++, rgba += 4)
+		if (rgba[3] >= 128)
+			addColor(rgba[0], rgba[1], rgba[2]);
+}
+void ColorQuantizer::merge(const ColorQuantizer& other)
+{
+	for (size_t i = 0; i < BINS; i++)
+		counts[i] += other.counts[i];
+	for (size_t i = 0; i < sums.size(); i++)
+		sums[i] += other.sums[i];
+	overflow = overflow || other.overflow;
+	if (!overflow)
+		exact.insert(other.exact.begin(), other.exact.end());
+	if (overflow || exact.size() > static_cast<size_t>(maxColors))
+	{
+		overflow = true;
+		exact.clear();
+	}
+}
+const std::vector<PixelRGB>& ColorQuantizer::buildPalette()
+{
+	palette.clear();
+	exactIndexes.clear();
+	binIndexes.clear();
+	if (!overflow)
+	{
+		std::vector<uint32_t> colors(exact.begin(), exact.end());
+		std::sort(colors.begin(), colors.end());
+		for (uint32_t color : colors)
+		{
+			exactIndexes[color] = static_cast<uint8_t>(palette.size());
+			palette.push_back({static_cast<uint8_t>(color >> 16), static_cast<uint8_t>(color >> 8), static_cast<uint8_t>(color)});
+		}
+		return palette;
+	}
+	medianCut();
+	return palette;
+}
+/**
+ * Box with the most pixels times its longest side is split at the median of that side,
+ * until there are maxColors boxes or no box spans more than one bin.
+ */
+void ColorQuantizer::medianCut()
+{
+	struct Box
+	{
+		size_t begin;
+		size_t end;
+		uint64_t population;
+		int axis;
+		int range;
+	};
+	std::vector<uint16_t> bins;
+	for (size_t i = 0; i < BINS; i++)
+		if (counts[i])
+			bins.push_back(static_cast<uint16_t>(i));
+	auto component = [](uint16_t bin, int axis) { return (bin >> (10 - 5 * axis)) & 0x1F; };
+	auto makeBox = [&](size_t begin, size_t end)
+	{
+		Box box {begin, end, 0, 0, 0};
+		int low[3] = {31, 31, 31};
+		int high[3] = {0, 0, 0};
+		for (size_t i = begin; i < end; i++)
+		{
+			box.population += counts[bins[i]];
+			for (int axis = 0; axis < 3; axis++)
+			{
+				low[axis] = std::min(low[axis], component(bins[i], axis));
+				high[axis] = std::max(high[axis], component(bins[i], axis));
+			}
+		}
+		for (int axis = 0; axis < 3; axis++)
+		{
+			if (high[axis] - low[axis] > box.range)
+			{
+				box.range = high[axis] - low[axis];
+				box.axis = axis;
+			}
+		}
+		return box;
+	};
+	std::vector<Box> boxes;
+	if (!bins.empty())
+		boxes.push_back(makeBox(0, bins.size()));
+	while (boxes.size() < static_cast<size_t>(maxColors))
+	{
+		Box* widest = nullptr;
+		for (Box& box : boxes)
+			if (box.range > 0 && (!widest || box.population * box.range > widest->population * widest->range))
+				widest = &box;
+		if (!widest)
+			break;
+		const Box BOX = *widest;
+		std::sort(bins.begin() + BOX.begin, bins.begin() + BOX.end, [&](uint16_t a, uint16_t b)
+		{
+			return component(a, BOX.axis) < component(b, BOX.axis);
+		});
+		size_t split = BOX.begin + 1;
+		uint64_t below = counts[bins[BOX.begin]];
+		while (split < BOX.end - 1 && below + counts[bins[split]] <= BOX.population / 2)
+			below += counts[bins[split++]];
+		*widest = makeBox(BOX.begin, split);
+		boxes.push_back(makeBox(split, BOX.end));
+	}
+	binIndexes.assign(BINS, NO_INDEX);
+	for (const Box& box : boxes)
+	{
+		uint64_t sum[3] = {0, 0, 0};
+		for (size_t i = box.begin; i < box.end; i++)
+		{
+			for (int c = 0; c < 3; c++)
+				sum[c] += sums[bins[i] * 3 + c];
+			binIndexes[bins[i]] = static_cast<uint16_t>(palette.size());
+		}
+		palette.push_back({static_cast<uint8_t>(sum[0] / box.population), static_cast<uint8_t>(sum[1] / box.population),
+			static_cast<uint8_t>(sum[2] / box.population)});
+	}
+}
+const std::vector<PixelRGB>& ColorQuantizer::getPalette() const
+{
+	return palette;
+}
+uint8_t ColorQuantizer::getIndex(uint8_t red, uint8_t green, uint8_t blue) const
+{
+	if (!overflow)
+	{
+		auto it = exactIndexes.find((static_cast<uint32_t>(red) << 16) | (green << 8) | blue);
+		if (it != exactIndexes.end())
+			return it->second;
+	}
+	else if (!binIndexes.empty() && binIndexes[binOf(red, green, blue)] != NO_INDEX)
+	{
+		return static_cast<uint8_t>(binIndexes[binOf(red, green, blue)]);
+	}
+	// Color never added, search the whole palette
+	uint8_t nearest = 0;
+	int best = 1 << 30;
+	for (size_t i = 0; i < palette.size(); i++)
+	{
+		const int R = palette[i].red - red;
+		const int G = palette[i].green - green;
+		const int B = palette[i].blue - blue;
+		const int DISTANCE = R * R + G * G + B * B;
+		if (DISTANCE < best)
+		{
+			best = DISTANCE;
+			nearest = static_cast<uint8_t>(i);
+		}
+	}
+	return nearest;
+}
+} /* namespace consoleartlib */
@@ -0,0 +1,108 @@
+//==============================================================================
+// File       : FrameStore.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Animation frames stored as keyframes and changed rectangles
+//==============================================================================
+
+#include "../../consoleartlib/images/utils/frame_store.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace consoleartlib
+{
+FrameStore::FrameStore(int width, int height, int channels, size_t rowStride, size_t keyframeInterval, std::pmr::memory_resource* resource) :
+	width(width), height(height), channels(channels), rowStride(rowStride), keyframeInterval(std::max<size_t>(keyframeInterval, 1)),
+	last(resource), resource(resource)
+{
+}
+void FrameStore::addFrame(const uint8_t* frame)
+{
+	const size_t ROW_SIZE = static_cast<size_t>(width) * channels;
+	const size_t SIZE = rowStride * height;
+	StoredFrame stored { 0, 0, 0, 0, PixelBuffer(resource) };
+	if (frames.size() % keyframeInterval == 0)
+	{
+		stored.width = width;
+		stored.height = height;
+		stored.pixels.assign(frame, frame + SIZE);
+	}
+	else
+	{
+		// Changed rows bound the rectangle vertically, first and last changed byte of those rows horizontally
+		int top = 0;
+		while (top < height && std::memcmp(frame + top * rowStride, last.data() + top * rowStride, ROW_SIZE) == 0)
+			top++;
+		int bottom = height;
+		while (bottom > top && std::memcmp(frame + (bottom - 1) * rowStride, last.data() + (bottom - 1) * rowStride, ROW_SIZE) == 0)
+			bottom--;
+		size_t left = ROW_SIZE;
+		size_t right = 0;
+		for (int y = top; y < bottom; y++)
+		{
+			const uint8_t* row = frame + y * rowStride;
+			const uint8_t* previous = last.data() + y * rowStride;
+			size_t begin = 0;
+			while (begin < left && row[begin] == previous[begin])
+				begin++;
+			left = begin;
+			size_t end = ROW_SIZE;
+			while (end > right && row[end - 1] == previous[end - 1])
+				end--;
+			right = end;
+		}
+		if (top < bottom)
+		{
+			stored.x = static_cast<int>(left / channels);
+			stored.y = top;
+			stored.width = static_cast<int>((right + channels - 1) / channels) - stored.x;
+			stored.height = bottom - top;
+			const size_t RECT_ROW = static_cast<size_t>(stored.width) * channels;
+			stored.pixels.resize(RECT_ROW * stored.height);
+			for (int y = 0; y < stored.height; y++)
+				std::memcpy(stored.pixels.data() + y * RECT_ROW, frame + (stored.y + y) * rowStride + stored.x * channels, RECT_ROW);
+		}
+	}
+	frames.push_back(std::move(stored));
+	last.assign(frame, frame + SIZE);
+}
+bool FrameStore::getFrame(size_t index, PixelBuffer& target) const
+{
+	if (index >= frames.size())
+		return false;
+	if (index == frames.size() - 1)
+	{
+		target.assign(last.begin(), last.end());
+		return true;
+	}
+	const size_t KEYFRAME = index - index % keyframeInterval;
+	target.assign(frames[KEYFRAME].pixels.begin(), frames[KEYFRAME].pixels.end());
+	for (size_t i = KEYFRAME + 1; i <= index; i++)
+	{
+		const StoredFrame& stored = frames[i];
+		const size_t RECT_ROW = static_cast<size_t>(stored.width) * channels;
+		for (int y = 0; y < stored.height; y++)
+			std::memcpy(target.data() + (stored.y + y) * rowStride + stored.x * channels, stored.pixels.data() + y * RECT_ROW, RECT_ROW);
+	}
+	return true;
+}
+size_t FrameStore::getFrameCount() const
+{
+	return frames.size();
+}
+size_t FrameStore::getStoredBytes() const
+{
+	size_t bytes = last.size();
+	for (const StoredFrame& stored : frames)
+		bytes += stored.pixels.size();
+	return bytes;
+}
+void FrameStore::clear()
+{
+	frames.clear();
+	last.clear();
+}
+} /* namespace consoleartlib */
@@ -0,0 +1,87 @@
+//==============================================================================
+// File       : MappedFile.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Read-only memory mapping of a whole file
+//==============================================================================
+
+#include "../../consoleartlib/images/utils/mapped_file.h"
+
+#include <utility>
+
+#if defined(__linux__)
+	#include <fcntl.h>
+	#include <unistd.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+#endif
+
+namespace consoleartlib
+{
+MappedFile::MappedFile() : address(nullptr), length(0)
+{
+}
+MappedFile::MappedFile(MappedFile&& other) noexcept : address(std::exchange(other.address, nullptr)), length(std::exchange(other.length, 0))
+{
+}
+MappedFile::~MappedFile()
+{
+	unmap();
+}
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+	if (this != &other)
+	{
+		unmap();
+		address = std::exchange(other.address, nullptr);
+		length = std::exchange(other.length, 0);
+	}
+	return *this;
+}
+bool MappedFile::map(const std::string& filepath)
+{
+	unmap();
+#if defined(__linux__)
+	const int fd = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0)
+		return false;
+	struct stat info;
+	if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode) || info.st_size <= 0)
+	{
+		close(fd);
+		return false;
+	}
+	void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // Mapping keeps the file referenced
+	if (mapped == MAP_FAILED)
+		return false;
+	// Decoders walk the data front to back, so the kernel can read ahead aggressively
+	madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+	address = mapped;
+	length = static_cast<size_t>(info.st_size);
+	return true;
+#else
+	(void)filepath;
+	return false;
+#endif
+}
+void MappedFile::unmap()
+{
+#if defined(__linux__)
+	if (address)
+		munmap(address, length);
+#endif
+	address = nullptr;
+	length = 0;
+}
+bool MappedFile::isMapped() const
+{
+	return address != nullptr;
+}
+std::span<const uint8_t> MappedFile::getData() const
+{
+	return std::span<const uint8_t>(static_cast<const uint8_t*>(address), length);
+}
+} /* namespace consoleartlib */
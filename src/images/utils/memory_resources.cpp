@@ -0,0 +1,245 @@
+//==============================================================================
+// File       : MemoryResources.cpp
+// Author     : riyufuchi
+// Created on : Oct 17, 2026
+// Last edit  : Oct 17, 2026
+// Copyright  : Copyright (c) 2026, riyufuchi
+// Description: Memory resources for pixel buffers
+//==============================================================================
+
+#include "../../consoleartlib/images/utils/memory_resources.h"
+
+#include <new>
+#include <memory>
+#include <algorithm>
+
+#if defined(__linux__)
+	#include <sys/mman.h>
+#endif
+
+namespace consoleartlib
+{
+//
+// ArenaResource
+//
+ArenaResource::ArenaResource(size_t chunkSize, std::pmr::memory_resource* upstream) : upstream(upstream), chunkSize(chunkSize), currentChunk(0), used(0)
+{
+}
+ArenaResource::~ArenaResource()
+{
+	release();
+}
+void* ArenaResource::do_allocate(size_t bytes, size_t alignment)
+{
+	while (currentChunk < chunks.size())
+	{
+		const Chunk& chunk = chunks[currentChunk];
+		const size_t START = (reinterpret_cast<uintptr_t>(chunk.data) + used + alignment - 1) / alignment * alignment - reinterpret_cast<uintptr_t>(chunk.data);
+		if (START + bytes <= chunk.size)
+		{
+			used = START + bytes;
+			return chunk.data + START;
+		}
+		currentChunk++;
+		used = 0;
+	}
+	// Oversized requests get a chunk of their own
+	const size_t SIZE = std::max(chunkSize, bytes + alignment);
+	chunks.push_back({static_cast<std::byte*>(upstream->allocate(SIZE, alignof(std::max_align_t))), SIZE});
+	currentChunk = chunks.size() - 1;
+	used = 0;
+	return do_allocate(bytes, alignment);
+}
+void ArenaResource::do_deallocate(void*, size_t, size_t)
+{
+}
+bool ArenaResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
+void ArenaResource::reset()
+{
+	currentChunk = 0;
+	used = 0;
+}
+void ArenaResource::release()
+{
+	for (const Chunk& chunk : chunks)
+		upstream->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+	chunks.clear();
+	reset();
+}
+size_t ArenaResource::getCapacity() const
+{
+	size_t capacity = 0;
+	for (const Chunk& chunk : chunks)
+		capacity += chunk.size;
+	return capacity;
+}
+//
+// BufferPoolResource
+//
+BufferPoolResource::BufferPoolResource(size_t maxCachedBytes, std::pmr::memory_resource* upstream) : upstream(upstream),
+	maxCachedBytes(maxCachedBytes), cachedBytes(0)
+{
+}
+BufferPoolResource::~BufferPoolResource()
+{
+	release();
+}
+/**
+ * Small requests are kept exact, larger ones rounded up to whole pages,
+ * so images with slightly different sizes share buffers.
+ */
+size_t BufferPoolResource::roundCapacity(size_t bytes)
+{
+	constexpr size_t PAGE = 4096;
+	if (bytes < PAGE)
+		return bytes;
+	return (bytes + PAGE - 1) / PAGE * PAGE;
+}
+void* BufferPoolResource::do_allocate(size_t bytes, size_t alignment)
+{
+	if (alignment > BUFFER_ALIGNMENT)
+		return upstream->allocate(bytes, alignment); // Not pooled
+	const size_t CAPACITY = roundCapacity(bytes);
+	std::lock_guard<std::mutex> lock(mutex);
+	// Any cached buffer up to twice the size is good enough
+	auto it = freeBuffers.lower_bound(CAPACITY);
+	if (it != freeBuffers.end() && it->first <= 2 * CAPACITY)
+	{
+		void* buffer = it->second;
+		cachedBytes -= it->first;
+		freeBuffers.erase(it);
+		return buffer;
+	}
+	void* buffer = upstream->allocate(CAPACITY, BUFFER_ALIGNMENT);
+	capacities[buffer] = CAPACITY;
+	return buffer;
+}
+void BufferPoolResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+	if (alignment > BUFFER_ALIGNMENT)
+	{
+		upstream->deallocate(p, bytes, alignment);
+		return;
+	}
+	std::lock_guard<std::mutex> lock(mutex);
+	auto it = capacities.find(p);
+	if (it == capacities.end())
+		return;
+	if (cachedBytes + it->second <= maxCachedBytes)
+	{
+		freeBuffers.emplace(it->second, p);
+		cachedBytes += it->second;
+		return;
+	}
+	upstream->deallocate(p, it->second, BUFFER_ALIGNMENT);
+	capacities.erase(it);
+}
+bool BufferPoolResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
+void BufferPoolResource::release()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const auto& [capacity, buffer] : freeBuffers)
+	{
+		upstream->deallocate(buffer, capacity, BUFFER_ALIGNMENT);
+		capacities.erase(buffer);
+	}
+	freeBuffers.clear();
+	cachedBytes = 0;
+}
+size_t BufferPoolResource::getCachedBytes()
+{
+	std::lock_guard<std::mutex> lock(mutex);
+	return cachedBytes;
+}
+//
+// AlignedResource
+//
+AlignedResource::AlignedResource(size_t alignment, std::pmr::memory_resource* upstream) : upstream(upstream), alignment(alignment)
+{
+}
+void* AlignedResource::do_allocate(size_t bytes, size_t alignment)
+{
+	return upstream->allocate(bytes, std::max(alignment, this->alignment));
+}
+void AlignedResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+	upstream->deallocate(p, bytes, std::max(alignment, this->alignment));
+}
+bool AlignedResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	const AlignedResource* aligned = dynamic_cast<const AlignedResource*>(&other);
+	return aligned && aligned->alignment == alignment && aligned->upstream->is_equal(*upstream);
+}
+std::pmr::memory_resource* AlignedResource::getUpstream() const
+{
+	return upstream;
+}
+std::pmr::memory_resource* AlignedResource::of(std::pmr::memory_resource* upstream, size_t alignment)
+{
+	static std::mutex registryMutex;
+	static std::map<std::pair<std::pmr::memory_resource*, size_t>, std::unique_ptr<AlignedResource>> registry;
+	std::lock_guard<std::mutex> lock(registryMutex);
+	std::unique_ptr<AlignedResource>& resource = registry[{upstream, alignment}];
+	if (!resource)
+		resource = std::make_unique<AlignedResource>(alignment, upstream);
+	return resource.get();
+}
+//
+// HugePageResource
+//
+HugePageResource::HugePageResource(size_t threshold, bool populate, std::pmr::memory_resource* upstream) : upstream(upstream),
+	threshold(threshold), populate(populate)
+{
+}
+void* HugePageResource::do_allocate(size_t bytes, size_t alignment)
+{
+	if (bytes < threshold || alignment > HUGE_PAGE_SIZE)
+		return upstream->allocate(bytes, alignment);
+	const size_t SIZE = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#if defined(__linux__)
+	// Map one huge page more, so the start can be moved to huge page boundary
+	int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+	if (populate)
+		flags |= MAP_POPULATE;
+	void* mapped = mmap(nullptr, SIZE + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, flags, -1, 0);
+	if (mapped == MAP_FAILED)
+		throw std::bad_alloc();
+	const uintptr_t BEGIN = reinterpret_cast<uintptr_t>(mapped);
+	const uintptr_t ALIGNED = (BEGIN + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+	if (ALIGNED > BEGIN)
+		munmap(mapped, ALIGNED - BEGIN);
+	if (ALIGNED + SIZE < BEGIN + SIZE + HUGE_PAGE_SIZE)
+		munmap(reinterpret_cast<void*>(ALIGNED + SIZE), BEGIN + HUGE_PAGE_SIZE - ALIGNED);
+	#ifdef MADV_HUGEPAGE
+	madvise(reinterpret_cast<void*>(ALIGNED), SIZE, MADV_HUGEPAGE);
+	#endif
+	return reinterpret_cast<void*>(ALIGNED);
+#else
+	return ::operator new(SIZE, std::align_val_t(HUGE_PAGE_SIZE));
+#endif
+}
+void HugePageResource::do_deallocate(void* p, size_t bytes, size_t alignment)
+{
+	if (bytes < threshold || alignment > HUGE_PAGE_SIZE)
+	{
+		upstream->deallocate(p, bytes, alignment);
+		return;
+	}
+	const size_t SIZE = (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+#if defined(__linux__)
+	munmap(p, SIZE);
+#else
+	::operator delete(p, SIZE, std::align_val_t(HUGE_PAGE_SIZE));
+#endif
+}
+bool HugePageResource::do_is_equal(const std::pmr::memory_resource& other) const noexcept
+{
+	return this == &other;
+}
+} /* namespace consoleartlib */